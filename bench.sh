@@ -1,20 +1,230 @@
 #!/bin/sh
+#
+# Run the benchmarks and import the results into db/db.sqlite.
+#
+# All arguments are passed on to build/bench, e.g.
+#
+#   ./bench.sh -w workloads/large.conf -t nightly
+#
+# The run is split into one job per product, phase and scale, all with the
+# same workload (and seed). The jobs of a product share one benchmark id,
+# whose experiments and runs rows are written once. With CPUS, a list of
+# CPUs set aside for benchmarking (e.g. with isolcpus), jobs run in
+# parallel, each pinned to a CPU of its own:
+#
+#   CPUS=2-5,8 PRODUCTS="libhamt avl rb swiss" ./bench.sh -t nightly
+#
+# Only one hardware thread per core of CPUS is used, so that no two jobs
+# share a core. Jobs that would disturb each other run alone afterwards,
+# on all of these CPUs: the phases with threads of their own
+# (parallel_query, snapshot) and scales above SHARED_MAX_SCALE (default
+# 100000), whose tables compete for the shared last-level cache and memory
+# bandwidth. Without CPUS, jobs run one after the other, unpinned.
+#
+# PRODUCTS, a list of products to restrict the run to, defaults to every
+# backend compiled into build/bench (see build/bench -h) and the libhamt
+# instruction set variants (make hamt-variants) the CPU supports, named
+# libhamt-<variant>, leaving out the products that cannot run the workload.
+# The results are merged into the database in a single transaction once all
+# jobs have succeeded.
+#
 
-GITCOMMIT=`(cd ../hamt && git describe --always)`
-echo "hamt"
-build/bench-hamt | sed -u -e "s/^/"libhamt-pool",$GITCOMMIT,/" > db/import.$$
-# echo "glib-hashtable"
-# build/bench-glib | sed -u -e "s/^/"glib2","",/" >> db/import.$$
-# echo "avl"
-# build/bench-avl | sed -u -e "s/^/"avl","",/" >> db/import.$$
-# echo "rb"
-# build/bench-rb | sed -u -e "s/^/"rb","",/" >> db/import.$$
-# echo "hsearch"
-# build/bench-hsearch | sed -u -e "s/^/"hsearch","",/" >> db/import.$$
+DB=${DB:-db/db.sqlite}
+SHARED_MAX_SCALE=${SHARED_MAX_SCALE:-100000}
 
+GITCOMMIT=`(cd lib/hamt && git describe --always)`
+TMP=`mktemp -d db/bench.XXXXXX` || exit 1
+
+# the effective workload, so that every job runs the same one
+build/bench "$@" -n > $TMP/workload.conf || exit 1
+PHASES=`sed -n -e 's/^phases = //p' $TMP/workload.conf | tr -d ' ' | tr ',' ' '`
+SCALES=`sed -n -e 's/^scales = //p' $TMP/workload.conf | tr -d ' ' | tr ',' ' '`
+
+# the backends of build/bench, and the libhamt instruction set variants
+# where the CPU has the instructions
+if [ -z "$PRODUCTS" ]; then
+    ALL_PRODUCTS=1
+    PRODUCTS=`build/bench -h 2>&1 | sed -n -e '/^available backends:/,$s/^  *//p' | tr '\n' ' '`
+    for BIN in build/bench-hamt-*; do
+        [ -x "$BIN" ] || continue
+        VARIANT=${BIN#build/bench-hamt-}
+        if [ "$VARIANT" != generic ] && ! grep -qw "$VARIANT" /proc/cpuinfo 2> /dev/null; then
+            echo "skipping libhamt-$VARIANT: no $VARIANT on this CPU"
+            continue
+        fi
+        PRODUCTS="$PRODUCTS libhamt-$VARIANT"
+    done
+fi
+
+# "2-5,8" -> "2 3 4 5 8"
+expand_cpus() {
+    for RANGE in `echo "$1" | tr ',' ' '`; do
+        case $RANGE in
+        *-*) seq ${RANGE%-*} ${RANGE#*-} ;;
+        *) echo $RANGE ;;
+        esac
+    done | tr '\n' ' '
+}
+
+# one CPU per core: skip CPUs whose SMT sibling is already a slot
+SLOTS=""
+for CPU in `expand_cpus "$CPUS"`; do
+    SIBLINGS=`cat /sys/devices/system/cpu/cpu$CPU/topology/thread_siblings_list 2> /dev/null`
+    SHARED=""
+    for SIBLING in `expand_cpus "$SIBLINGS"`; do
+        case " $SLOTS " in *" $SIBLING "*) SHARED=$SIBLING ;; esac
+    done
+    if [ -n "$SHARED" ]; then
+        echo "not using cpu $CPU: SMT sibling of cpu $SHARED"
+    else
+        SLOTS="$SLOTS $CPU"
+    fi
+done
+if [ -n "$CPUS" ] && ! command -v taskset > /dev/null; then
+    echo "taskset not found, running unpinned"
+    SLOTS=""
+fi
+
+# product_bin PRODUCT: the driver to run it with and its libhamt commit
+product_bin() {
+    case $1 in
+    libhamt) BIN=build/bench COMMIT=$GITCOMMIT ;;
+    libhamt-*) BIN=build/bench-hamt-${1#libhamt-} COMMIT=$GITCOMMIT ;;
+    *) BIN=build/bench COMMIT="" ;;
+    esac
+}
+
+# one benchmark id per product; a dry run writes its experiments and runs
+# rows, and fails early if the product cannot run the workload (by
+# default, such products are left out, e.g. hsearch with allocator = pool)
+RUNNABLE=""
+for PRODUCT in $PRODUCTS; do
+    ID=`cat /proc/sys/kernel/random/uuid 2> /dev/null || uuidgen | tr A-F a-f`
+    echo $ID > $TMP/$PRODUCT.id
+    product_bin $PRODUCT
+    if ! $BIN -w $TMP/workload.conf -b $ID -e $TMP/experiments.csv \
+        -r $TMP/runs.csv -n $PRODUCT > /dev/null; then
+        [ -n "$ALL_PRODUCTS" ] || exit 1
+        echo "skipping $PRODUCT"
+        continue
+    fi
+    RUNNABLE="$RUNNABLE $PRODUCT"
+done
+PRODUCTS=$RUNNABLE
+
+# the job lists: product, phase and scale per line
+for PRODUCT in $PRODUCTS; do
+    for PHASE in $PHASES; do
+        for SCALE in $SCALES; do
+            case $PHASE in
+            parallel_query | snapshot) QUEUE=exclusive ;;
+            *) [ "$SCALE" -gt "$SHARED_MAX_SCALE" ] && QUEUE=exclusive || QUEUE=shared ;;
+            esac
+            echo "$PRODUCT $PHASE $SCALE" >> $TMP/$QUEUE
+        done
+    done
+done
+touch $TMP/shared $TMP/exclusive
+
+# run_job JOB PRODUCT PHASE SCALE [CPUS]
+run_job() {
+    product_bin $2
+    PIN=""
+    [ -n "$5" ] && PIN="taskset -c $5"
+    # the memory phase counts the allocations of products without allocator
+    # hooks with the malloc shim, the timed phases run without it
+    PRELOAD=""
+    [ "$3" = memory ] && [ -e build/libmemcount.so ] &&
+        PRELOAD="env LD_PRELOAD=$PWD/build/libmemcount.so"
+    echo "${5:+[$5] }$2 $3 $4"
+    $PRELOAD $PIN $BIN -w $TMP/workload.conf -o phases=$3 -o scales=$4 \
+        -b `cat $TMP/$2.id` $2 < /dev/null > $TMP/$1.out || return 1
+    sed -e "s/^/\"$2\",\"$COMMIT\",/" $TMP/$1.out > $TMP/$1.import
+}
+
+# Each worker walks the shared jobs in order and runs those it claims;
+# mkdir is atomic, so every job is claimed by exactly one worker.
+worker() {
+    N=0
+    while read PRODUCT PHASE SCALE; do
+        N=$((N + 1))
+        mkdir $TMP/claim.$N 2> /dev/null || continue
+        run_job s$N $PRODUCT $PHASE $SCALE $1 || touch $TMP/failed
+    done < $TMP/shared
+}
+
+if [ -n "$SLOTS" ]; then
+    for CPU in $SLOTS; do
+        worker $CPU &
+    done
+    wait
+    ALL=`echo $SLOTS | tr ' ' ','`
+else
+    worker
+    ALL=""
+fi
+N=0
+while read PRODUCT PHASE SCALE; do
+    N=$((N + 1))
+    run_job x$N $PRODUCT $PHASE $SCALE $ALL || touch $TMP/failed
+done < $TMP/exclusive
+
+if [ -e $TMP/failed ]; then
+    echo "some jobs failed, nothing imported; results are in $TMP"
+    exit 1
+fi
+cat $TMP/*.import > $TMP/import.csv 2> /dev/null
+
+# create the base schema, then apply the migrations the database is missing
+sqlite3 $DB < db/benchmark.sql
+VERSION=`sqlite3 $DB "pragma user_version"`
+for MIGRATION in db/migrations/*.sql; do
+    N=`basename $MIGRATION | sed -e 's/-.*//' -e 's/^0*//'`
+    if [ "$N" -gt "$VERSION" ]; then
+        sqlite3 $DB < $MIGRATION || exit 1
+    fi
+done
+
+# import through staging tables so that empty CSV fields become NULL, all
+# or nothing
 {
 cat << EOF
+.bail on
+BEGIN;
+CREATE TEMP TABLE staging (
+    product, gitcommit, epoch, benchmark, repeat, measurement, scale,
+    threads, ns, p50, p90, p99, p999, pmax,
+    cycles, instructions, l1d_misses, llc_misses, dtlb_misses, branch_misses,
+    bytes, peak_bytes, allocs
+);
 .mode csv
-.import db/import.$$ numbers
+.import $TMP/import.csv staging
+INSERT INTO numbers (product, gitcommit, epoch, benchmark, repeat,
+    measurement, scale, threads, ns, p50, p90, p99, p999, pmax,
+    cycles, instructions, l1d_misses, llc_misses, dtlb_misses, branch_misses,
+    bytes, peak_bytes, allocs)
+SELECT product, gitcommit, epoch, benchmark, repeat, measurement, scale,
+    threads, ns, nullif(p50, ''), nullif(p90, ''), nullif(p99, ''),
+    nullif(p999, ''), nullif(pmax, ''),
+    nullif(cycles, ''), nullif(instructions, ''), nullif(l1d_misses, ''),
+    nullif(llc_misses, ''), nullif(dtlb_misses, ''),
+    nullif(branch_misses, ''), nullif(bytes, ''), nullif(peak_bytes, ''),
+    nullif(allocs, '')
+FROM staging;
+.import $TMP/experiments.csv experiments
+CREATE TEMP TABLE staging_runs (
+    benchmark, hostname, cpu_model, cpus, l1d_cache, l1i_cache, l2_cache,
+    l3_cache, governor, turbo, kernel, compiler, cflags, bench_commit,
+    hamt_commit, allocator
+);
+.import $TMP/runs.csv staging_runs
+INSERT INTO runs
+SELECT benchmark, hostname, cpu_model, cpus, nullif(l1d_cache, ''),
+    nullif(l1i_cache, ''), nullif(l2_cache, ''), nullif(l3_cache, ''),
+    nullif(governor, ''), nullif(turbo, ''), kernel, compiler, cflags,
+    nullif(bench_commit, ''), nullif(hamt_commit, ''), allocator
+FROM staging_runs;
+COMMIT;
 EOF
-} | sqlite3 db/db.sqlite
+} | sqlite3 $DB || { echo "import failed, results are in $TMP"; exit 1; }
+rm -r $TMP
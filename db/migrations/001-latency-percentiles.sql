@@ -0,0 +1,24 @@
+-- per-operation latency percentiles in ns, see print_result() in src/bench.c
+ALTER TABLE numbers ADD COLUMN p50 real;
+ALTER TABLE numbers ADD COLUMN p90 real;
+ALTER TABLE numbers ADD COLUMN p99 real;
+ALTER TABLE numbers ADD COLUMN p999 real;
+ALTER TABLE numbers ADD COLUMN pmax real;
+DROP VIEW IF EXISTS latency_stats;
+CREATE VIEW latency_stats as
+select
+    product,
+    gitcommit,
+    benchmark,
+    measurement,
+    scale,
+    avg(ns) as mean,
+    avg(p50) as p50,
+    avg(p90) as p90,
+    avg(p99) as p99,
+    avg(p999) as p999,
+    max(pmax) as max
+from numbers
+where p50 is not null
+group by product, gitcommit, benchmark, measurement, scale;
+PRAGMA user_version = 1;
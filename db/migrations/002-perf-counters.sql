@@ -0,0 +1,27 @@
+-- hardware performance counters per operation, see src/perf.h
+ALTER TABLE numbers ADD COLUMN cycles real;
+ALTER TABLE numbers ADD COLUMN instructions real;
+ALTER TABLE numbers ADD COLUMN l1d_misses real;
+ALTER TABLE numbers ADD COLUMN llc_misses real;
+ALTER TABLE numbers ADD COLUMN dtlb_misses real;
+ALTER TABLE numbers ADD COLUMN branch_misses real;
+DROP VIEW IF EXISTS counter_stats;
+CREATE VIEW counter_stats as
+select
+    product,
+    gitcommit,
+    benchmark,
+    measurement,
+    scale,
+    avg(ns) as ns,
+    avg(cycles) as cycles,
+    avg(instructions) as instructions,
+    avg(instructions) / avg(cycles) as ipc,
+    avg(l1d_misses) as l1d_misses,
+    avg(llc_misses) as llc_misses,
+    avg(dtlb_misses) as dtlb_misses,
+    avg(branch_misses) as branch_misses
+from numbers
+where cycles is not null
+group by product, gitcommit, benchmark, measurement, scale;
+PRAGMA user_version = 2;
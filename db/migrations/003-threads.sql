@@ -0,0 +1,108 @@
+-- thread count per measurement, part of the primary key; earlier rows
+-- come from single-threaded runs
+BEGIN;
+CREATE TABLE numbers_new (
+    product text,
+    gitcommit text,
+    epoch integer,
+    benchmark text,
+    repeat text,
+    measurement text,
+    scale integer,
+    threads integer not null default 1,
+    ns real,
+    p50 real,
+    p90 real,
+    p99 real,
+    p999 real,
+    pmax real,
+    cycles real,
+    instructions real,
+    l1d_misses real,
+    llc_misses real,
+    dtlb_misses real,
+    branch_misses real,
+    primary key (product, gitcommit, epoch, benchmark, repeat, measurement,
+                 scale, threads)
+);
+INSERT INTO numbers_new (product, gitcommit, epoch, benchmark, repeat,
+    measurement, scale, ns, p50, p90, p99, p999, pmax, cycles, instructions,
+    l1d_misses, llc_misses, dtlb_misses, branch_misses)
+SELECT product, gitcommit, epoch, benchmark, repeat, measurement, scale, ns,
+    p50, p90, p99, p999, pmax, cycles, instructions, l1d_misses, llc_misses,
+    dtlb_misses, branch_misses
+FROM numbers;
+DROP VIEW IF EXISTS summary_stats;
+DROP VIEW IF EXISTS latency_stats;
+DROP VIEW IF EXISTS counter_stats;
+DROP TABLE numbers;
+ALTER TABLE numbers_new RENAME TO numbers;
+CREATE INDEX if not exists ix_numbers_gitcommit on numbers(gitcommit);
+CREATE INDEX if not exists ix_numbers_benchmark on numbers(benchmark);
+CREATE INDEX if not exists ix_numbers_measurement on numbers(measurement);
+CREATE INDEX if not exists ix_numbers_scale on numbers(scale);
+CREATE VIEW summary_stats as
+select
+    product,
+    gitcommit,
+    benchmark,
+    measurement,
+    scale,
+    avg(ns) as mean,
+    sqrt(avg((ns - sub.mu) * (ns - sub.mu))) as stddev,
+    min(ns) as min,
+    max(ns) as max
+from
+    numbers,
+    (select avg(ns) as mu from numbers) as sub
+group by product, gitcommit, benchmark, measurement, scale;
+CREATE VIEW latency_stats as
+select
+    product,
+    gitcommit,
+    benchmark,
+    measurement,
+    scale,
+    threads,
+    avg(ns) as mean,
+    avg(p50) as p50,
+    avg(p90) as p90,
+    avg(p99) as p99,
+    avg(p999) as p999,
+    max(pmax) as max
+from numbers
+where p50 is not null
+group by product, gitcommit, benchmark, measurement, scale, threads;
+CREATE VIEW counter_stats as
+select
+    product,
+    gitcommit,
+    benchmark,
+    measurement,
+    scale,
+    avg(ns) as ns,
+    avg(cycles) as cycles,
+    avg(instructions) as instructions,
+    avg(instructions) / avg(cycles) as ipc,
+    avg(l1d_misses) as l1d_misses,
+    avg(llc_misses) as llc_misses,
+    avg(dtlb_misses) as dtlb_misses,
+    avg(branch_misses) as branch_misses
+from numbers
+where cycles is not null
+group by product, gitcommit, benchmark, measurement, scale;
+CREATE VIEW scaling_stats as
+select
+    product,
+    gitcommit,
+    benchmark,
+    measurement,
+    scale,
+    threads,
+    avg(ns) as ns,
+    1e3 / avg(ns) as mops
+from numbers
+where measurement like 'parallel_%'
+group by product, gitcommit, benchmark, measurement, scale, threads;
+PRAGMA user_version = 3;
+COMMIT;
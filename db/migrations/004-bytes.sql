@@ -0,0 +1,22 @@
+-- memory per operation in bytes, for measurements that track allocations
+ALTER TABLE numbers ADD COLUMN bytes real;
+DROP VIEW IF EXISTS snapshot_stats;
+CREATE VIEW snapshot_stats as
+select
+    w.product,
+    w.gitcommit,
+    w.benchmark,
+    w.scale,
+    w.threads as readers,
+    avg(w.ns) as write_ns,
+    1e3 / avg(w.ns) as write_mops,
+    avg(w.bytes) as bytes_per_version,
+    (select avg(r.ns) from numbers r
+     where r.product = w.product and r.gitcommit = w.gitcommit
+       and r.benchmark = w.benchmark and r.scale = w.scale
+       and r.threads = w.threads and r.measurement = 'snapshot_read')
+        as read_ns
+from numbers w
+where w.measurement = 'snapshot_write'
+group by w.product, w.gitcommit, w.benchmark, w.scale, w.threads;
+PRAGMA user_version = 4;
@@ -0,0 +1,18 @@
+-- peak bytes and allocations per operation, next to the live bytes
+ALTER TABLE numbers ADD COLUMN peak_bytes real;
+ALTER TABLE numbers ADD COLUMN allocs real;
+DROP VIEW IF EXISTS memory_stats;
+CREATE VIEW memory_stats as
+select
+    product,
+    gitcommit,
+    benchmark,
+    scale,
+    avg(bytes) as bytes_per_key,
+    avg(peak_bytes) as peak_bytes_per_key,
+    avg(allocs) as allocs_per_key,
+    avg(bytes) * scale as total_bytes
+from numbers
+where measurement = 'memory'
+group by product, gitcommit, benchmark, scale;
+PRAGMA user_version = 5;
@@ -0,0 +1,3 @@
+-- allocator the tables under test were created with, see src/alloc.h
+ALTER TABLE experiments ADD COLUMN allocator text default 'default';
+PRAGMA user_version = 6;
@@ -0,0 +1,18 @@
+-- full-table scans: time and cache misses per visited entry
+DROP VIEW IF EXISTS iterate_stats;
+CREATE VIEW iterate_stats as
+select
+    product,
+    gitcommit,
+    benchmark,
+    measurement,
+    scale,
+    avg(ns) as ns_per_entry,
+    1e3 / avg(ns) as mentries_per_s,
+    avg(l1d_misses) as l1d_misses_per_entry,
+    avg(llc_misses) as llc_misses_per_entry,
+    avg(dtlb_misses) as dtlb_misses_per_entry
+from numbers
+where measurement like 'iterate%'
+group by product, gitcommit, benchmark, measurement, scale;
+PRAGMA user_version = 7;
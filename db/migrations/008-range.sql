@@ -0,0 +1,18 @@
+-- range scans: time and cache misses per visited key
+DROP VIEW IF EXISTS range_stats;
+CREATE VIEW range_stats as
+select
+    product,
+    gitcommit,
+    benchmark,
+    measurement,
+    scale,
+    avg(ns) as ns_per_key,
+    1e3 / avg(ns) as mkeys_per_s,
+    avg(l1d_misses) as l1d_misses_per_key,
+    avg(llc_misses) as llc_misses_per_key,
+    avg(dtlb_misses) as dtlb_misses_per_key
+from numbers
+where measurement like 'range%'
+group by product, gitcommit, benchmark, measurement, scale;
+PRAGMA user_version = 8;
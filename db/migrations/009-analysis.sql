@@ -0,0 +1,216 @@
+-- robust statistics over the repetitions of a measurement, with the warmup
+-- and outlier definitions of src/stats.h (the confidence interval of the
+-- median is by order statistics here, by bootstrap there)
+--
+-- summary_stats took the deviations from the mean of the whole table
+-- rather than of each group, and mixed thread counts: use the group mean
+-- and Bessel's correction, per thread count
+DROP VIEW IF EXISTS summary_stats;
+CREATE VIEW summary_stats as
+select
+    product,
+    gitcommit,
+    benchmark,
+    measurement,
+    scale,
+    threads,
+    avg(ns) as mean,
+    sqrt(sum((ns - mu) * (ns - mu)) / max(count(*) - 1, 1)) as stddev,
+    min(ns) as min,
+    max(ns) as max
+from
+    numbers
+    join (
+        select product, gitcommit, benchmark, measurement, scale, threads,
+            avg(ns) as mu
+        from numbers
+        group by product, gitcommit, benchmark, measurement, scale, threads
+    ) using (product, gitcommit, benchmark, measurement, scale, threads)
+group by product, gitcommit, benchmark, measurement, scale, threads;
+-- every row with its position among the repetitions (rep, from 1), whether
+-- it is part of the warmup (MSER) and whether it is an outlier among the
+-- steady-state rows (modified z-score above 3.5)
+DROP VIEW IF EXISTS numbers_flagged;
+CREATE VIEW numbers_flagged as
+with suffix as (
+    -- sums over this and all later repetitions, m is their number
+    select
+        rowid as id,
+        product, gitcommit, benchmark, measurement, scale, threads, ns,
+        row_number() over later as rep,
+        count(*) over later as m,
+        sum(ns) over later as s1,
+        sum(ns * ns) over later as s2
+    from numbers
+    window later as (
+        partition by product, gitcommit, benchmark, measurement, scale,
+            threads
+        order by epoch, cast(repeat as integer)
+        rows between current row and unbounded following
+    )
+),
+cut as (
+    -- the warmup d <= n/2 minimising the squared standard error of the
+    -- mean of the rest; ties go to the shorter warmup
+    select
+        product, gitcommit, benchmark, measurement, scale, threads,
+        rep - 1 as warmup,
+        row_number() over (
+            partition by product, gitcommit, benchmark, measurement, scale,
+                threads
+            order by (s2 - s1 * s1 / m) / (m * m), rep
+        ) as best
+    from suffix
+    where rep - 1 <= (m + rep - 1) / 2
+),
+steady as (
+    select
+        id, product, gitcommit, benchmark, measurement, scale, threads, ns,
+        rep, rep <= warmup as warmup
+    from suffix
+        join cut
+        using (product, gitcommit, benchmark, measurement, scale, threads)
+    where best = 1
+),
+med as (
+    select
+        product, gitcommit, benchmark, measurement, scale, threads,
+        avg(ns) as median
+    from (
+        select
+            product, gitcommit, benchmark, measurement, scale, threads, ns,
+            row_number() over sorted as i,
+            count(*) over g as m
+        from steady
+        where not warmup
+        window
+            g as (partition by product, gitcommit, benchmark, measurement,
+                scale, threads),
+            sorted as (g order by ns)
+    )
+    where i in ((m + 1) / 2, (m + 2) / 2)
+    group by product, gitcommit, benchmark, measurement, scale, threads
+),
+mad as (
+    select
+        product, gitcommit, benchmark, measurement, scale, threads,
+        median,
+        avg(dev) as mad
+    from (
+        select
+            product, gitcommit, benchmark, measurement, scale, threads,
+            median,
+            abs(ns - median) as dev,
+            row_number() over sorted as i,
+            count(*) over g as m
+        from steady
+            join med
+            using (product, gitcommit, benchmark, measurement, scale,
+                threads)
+        where not warmup
+        window
+            g as (partition by product, gitcommit, benchmark, measurement,
+                scale, threads),
+            sorted as (g order by abs(ns - median))
+    )
+    where i in ((m + 1) / 2, (m + 2) / 2)
+    group by product, gitcommit, benchmark, measurement, scale, threads
+)
+select
+    numbers.*,
+    steady.rep,
+    steady.warmup,
+    not steady.warmup and mad.mad > 0
+        and abs(steady.ns - mad.median) / (1.4826 * mad.mad) > 3.5
+        as outlier
+from numbers
+    join steady on steady.id = numbers.rowid
+    join mad using (product, gitcommit, benchmark, measurement, scale,
+        threads);
+-- per measurement, over the rows after the warmup: mean and standard
+-- deviation, median and MAD, and 95% confidence intervals of the mean
+-- (normal) and of the median (order statistics, distribution free)
+DROP VIEW IF EXISTS robust_stats;
+CREATE VIEW robust_stats as
+with ranked as (
+    select
+        product, gitcommit, benchmark, measurement, scale, threads, ns,
+        outlier,
+        row_number() over sorted as i,
+        count(*) over g as m
+    from numbers_flagged
+    where not warmup
+    window
+        g as (partition by product, gitcommit, benchmark, measurement,
+            scale, threads),
+        sorted as (g order by ns)
+),
+centre as (
+    -- the bounds of the median's interval are the values of ranks
+    -- m/2 -+ 1.96 sqrt(m)/2
+    select
+        product, gitcommit, benchmark, measurement, scale, threads,
+        count(*) as n,
+        sum(outlier) as n_outliers,
+        avg(ns) as mean,
+        avg(ns) filter (where i in ((m + 1) / 2, (m + 2) / 2)) as median,
+        max(ns) filter (where i = max(1,
+            cast(floor(m / 2.0 - 0.98 * sqrt(m)) as integer))) as median_lo,
+        max(ns) filter (where i = min(m,
+            cast(ceil(m / 2.0 + 1 + 0.98 * sqrt(m)) as integer))) as median_hi
+    from ranked
+    group by product, gitcommit, benchmark, measurement, scale, threads
+),
+spread as (
+    select
+        product, gitcommit, benchmark, measurement, scale, threads,
+        sqrt(sum((ns - mean) * (ns - mean)) / max(n - 1, 1)) as stddev,
+        avg(dev) filter (where j in ((n + 1) / 2, (n + 2) / 2)) as mad
+    from (
+        select
+            product, gitcommit, benchmark, measurement, scale, threads, ns,
+            n, mean,
+            abs(ns - median) as dev,
+            row_number() over (
+                partition by product, gitcommit, benchmark, measurement,
+                    scale, threads
+                order by abs(ns - median)
+            ) as j
+        from ranked
+            join centre
+            using (product, gitcommit, benchmark, measurement, scale,
+                threads)
+    )
+    group by product, gitcommit, benchmark, measurement, scale, threads
+),
+warmup as (
+    select
+        product, gitcommit, benchmark, measurement, scale, threads,
+        sum(warmup) as n_warmup
+    from numbers_flagged
+    group by product, gitcommit, benchmark, measurement, scale, threads
+)
+select
+    product,
+    gitcommit,
+    benchmark,
+    measurement,
+    scale,
+    threads,
+    n,
+    n_warmup,
+    n_outliers,
+    mean,
+    stddev,
+    mean - 1.96 * stddev / sqrt(n) as mean_lo,
+    mean + 1.96 * stddev / sqrt(n) as mean_hi,
+    median,
+    mad,
+    median_lo,
+    median_hi
+from centre
+    join spread
+    using (product, gitcommit, benchmark, measurement, scale, threads)
+    join warmup
+    using (product, gitcommit, benchmark, measurement, scale, threads);
+PRAGMA user_version = 9;
@@ -0,0 +1,21 @@
+-- machine and build of every benchmark run, see src/env.h; join with
+-- numbers and experiments on benchmark
+CREATE TABLE IF NOT EXISTS runs (
+    benchmark text primary key,
+    hostname text,
+    cpu_model text,
+    cpus integer,
+    l1d_cache integer,
+    l1i_cache integer,
+    l2_cache integer,
+    l3_cache integer,
+    governor text,
+    turbo text,
+    kernel text,
+    compiler text,
+    cflags text,
+    bench_commit text,
+    hamt_commit text
+);
+CREATE INDEX if not exists ix_runs_hostname on runs(hostname);
+PRAGMA user_version = 10;
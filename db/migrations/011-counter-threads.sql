@@ -0,0 +1,24 @@
+-- counter_stats per thread count: 003 added the threads column but
+-- recreated counter_stats averaging over all thread counts (009 did the
+-- same fix for summary_stats)
+DROP VIEW IF EXISTS counter_stats;
+CREATE VIEW counter_stats as
+select
+    product,
+    gitcommit,
+    benchmark,
+    measurement,
+    scale,
+    threads,
+    avg(ns) as ns,
+    avg(cycles) as cycles,
+    avg(instructions) as instructions,
+    avg(instructions) / avg(cycles) as ipc,
+    avg(l1d_misses) as l1d_misses,
+    avg(llc_misses) as llc_misses,
+    avg(dtlb_misses) as dtlb_misses,
+    avg(branch_misses) as branch_misses
+from numbers
+where cycles is not null
+group by product, gitcommit, benchmark, measurement, scale, threads;
+PRAGMA user_version = 11;
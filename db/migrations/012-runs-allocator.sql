@@ -0,0 +1,8 @@
+-- the allocator of every run, next to the rest of its configuration; it
+-- was only recorded in experiments, see 006
+ALTER TABLE runs ADD COLUMN allocator text;
+UPDATE runs SET allocator = (
+    select allocator from experiments
+    where experiments.benchmark = runs.benchmark
+);
+PRAGMA user_version = 12;
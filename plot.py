@@ -5,15 +5,6 @@ import matplotlib.lines as mlines
 import numpy as np
 
 
-def trim(arr, trim):
-    """
-    Trim the top and bottom 0.5*TRIM*100% values from ARR.
-    """
-    n = len(arr)
-    k = int(round(n * float(trim) / 2))
-    s = sorted(arr)
-    return s[k+1:n-k]
-
 def subplots(i, j):
     # subplots with a consistent return type (always a numpy array)
     fig, axs = plt.subplots(i, j)  #, layout='constrained')
@@ -23,7 +14,9 @@ def subplots(i, j):
 
 
 def query_stats():
-    query = """SELECT product || ':' || gitcommit || ':' || substr(benchmark, 1, 4) as id, measurement, scale, repeat, ns FROM numbers;"""
+    # median and its 95% confidence interval after the warmup, see
+    # db/migrations/009-analysis.sql
+    query = """SELECT product || ':' || gitcommit || ':' || substr(benchmark, 1, 4) as id, measurement, scale, median, median_lo, median_hi FROM robust_stats WHERE threads = 1;"""
     conn = sqlite3.connect("db/db.sqlite")
     df2 = pd.read_sql_query(query, conn)
     conn.close()
@@ -46,22 +39,24 @@ def create_plot():
         handles = []
         for label in labels:
             times = [np.nan] * len(scales)
-            time_cis = [0.0] * len(scales)
+            time_cis = [[0.0] * len(scales), [0.0] * len(scales)]
             handle = dhs[cmap[label]]
             for ix, scale in enumerate(sorted(scales)):
                 data = df2.loc[
                     (df2["id"] == label)
                     & (df2["scale"] == scale)
                     & (df2["measurement"] == measurement)
-                ]["ns"]
+                ]
                 if not data.empty:
-                    trimmed_times = trim(data, 0.4)
-                    times[ix] = np.mean(trimmed_times)
-                    time_cis[ix] = 3*np.std(trimmed_times)
+                    row = data.iloc[0]
+                    times[ix] = row["median"]
+                    time_cis[0][ix] = row["median"] - row["median_lo"]
+                    time_cis[1][ix] = row["median_hi"] - row["median"]
                     if handle not in handles:
                         handles.append(dhs[cmap[label]])
                 else:
-                    times[ix], time_cis[ix] = np.nan, np.nan
+                    times[ix] = np.nan
+                    time_cis[0][ix], time_cis[1][ix] = np.nan, np.nan
             #axs[m_ix].plot(scales, times, "o-", label=label)
             # if not any(np.isnan(t) for t in times):
             axs[m_ix].errorbar(scales, times, yerr=time_cis, fmt=".-", label=label)
@@ -1,18 +1,46 @@
 #!/bin/bash
+#
+# Profile libhamt phase by phase with gperftools and render the profiles.
+#
+# Arguments are passed on to build/profile-hamt ([n_words [reps]]). For
+# each phase this writes hamt-<phase>-<uuid>.{prof,txt,svg} and, if
+# flamegraph.pl is on the PATH, a flame graph hamt-<phase>-<uuid>-flame.svg.
+# Set OPEN=1 to open the call graphs when done.
+#
+
+PPROF=${PPROF:-`command -v pprof || command -v google-pprof`}
+if [ -z "$PPROF" ]; then
+    echo "pprof not found (install gperftools or set PPROF)" >&2
+    exit 1
+fi
 
 #
 # run profiling
 #
-UUID=`CPUPROFILE_FREQUENCY=10000 build/profile-hamt`
+UUID=`CPUPROFILE_FREQUENCY=10000 build/profile-hamt "$@"` || exit 1
 
 #
 # create reports
 #
-INSERT_TRANSIENT="hamt-insert-transient-${UUID}"
-INSERT_PERSISTENT="hamt-insert-persistent-${UUID}"
-QUERY="hamt-query-${UUID}"
+OUTPUTS=""
+for PHASE in insert-transient insert-persistent query remove; do
+    NAME="hamt-${PHASE}-${UUID}"
+    "$PPROF" --text build/profile-hamt "${NAME}.prof" > "${NAME}.txt"
+    "$PPROF" --svg build/profile-hamt "${NAME}.prof" > "${NAME}.svg"
+    OUTPUTS="$OUTPUTS ${NAME}.svg"
+    if command -v flamegraph.pl > /dev/null; then
+        "$PPROF" --collapsed build/profile-hamt "${NAME}.prof" |
+            flamegraph.pl --title "hamt ${PHASE}" > "${NAME}-flame.svg"
+        OUTPUTS="$OUTPUTS ${NAME}-flame.svg"
+    fi
+    echo "${PHASE}:"
+    head -n 12 "${NAME}.txt"
+done
 
-pprof --pdf build/profile-hamt "${INSERT_TRANSIENT}.prof" > "${INSERT_TRANSIENT}.pdf"
-pprof --pdf build/profile-hamt "${INSERT_PERSISTENT}.prof" > "${INSERT_PERSISTENT}.pdf"
-pprof --pdf build/profile-hamt "${QUERY}.prof" > "${QUERY}.pdf"
-open "${INSERT_TRANSIENT}.pdf" "${INSERT_PERSISTENT}.pdf" "${QUERY}.pdf"
+if [ "$OPEN" = "1" ]; then
+    if command -v xdg-open > /dev/null; then
+        for F in $OUTPUTS; do xdg-open "$F"; done
+    else
+        open $OUTPUTS
+    fi
+fi
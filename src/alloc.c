@@ -0,0 +1,314 @@
+#include "alloc.h"
+
+#include <dlfcn.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef WITH_GC
+#include <gc.h>
+#endif
+
+#if defined(__APPLE__)
+#include <malloc/malloc.h>
+#define block_size(p) malloc_size(p)
+#else
+#include <malloc.h>
+#define block_size(p) malloc_usable_size(p)
+#endif
+
+struct alloc_stats alloc_stats;
+
+static const struct {
+    enum allocator allocator;
+    const char *name;
+} allocator_names[] = {
+    {ALLOCATOR_DEFAULT, "default"},
+    {ALLOCATOR_COUNTING, "counting"},
+#ifdef WITH_GC
+    {ALLOCATOR_GC, "gc"},
+#endif
+    {ALLOCATOR_POOL, "pool"},
+    {ALLOCATOR_SLAB, "slab"},
+};
+
+static const size_t n_allocator_names =
+    sizeof(allocator_names) / sizeof(allocator_names[0]);
+
+const char *allocator_name(enum allocator allocator)
+{
+    for (size_t i = 0; i < n_allocator_names; ++i) {
+        if (allocator_names[i].allocator == allocator)
+            return allocator_names[i].name;
+    }
+    return "unknown";
+}
+
+int allocator_parse(const char *name, enum allocator *allocator)
+{
+    for (size_t i = 0; i < n_allocator_names; ++i) {
+        if (strcmp(allocator_names[i].name, name) == 0) {
+            *allocator = allocator_names[i].allocator;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+static const char *layout_names[] = {"none", "bfs", "veb"};
+
+const char *layout_name(enum layout layout) { return layout_names[layout]; }
+
+int layout_parse(const char *name, enum layout *layout)
+{
+    for (int i = LAYOUT_NONE; i <= LAYOUT_VEB; ++i) {
+        if (strcmp(layout_names[i], name) == 0) {
+            *layout = (enum layout)i;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+void allocator_init(enum allocator allocator)
+{
+#ifdef WITH_GC
+    if (allocator == ALLOCATOR_GC)
+        GC_INIT();
+#endif
+}
+
+void alloc_stats_reset(void)
+{
+    alloc_stats.live = 0;
+    alloc_stats.peak = 0;
+    alloc_stats.n_allocs = 0;
+}
+
+static void account_alloc(void *p)
+{
+    alloc_stats.live += block_size(p);
+    alloc_stats.n_allocs++;
+    if (alloc_stats.live > alloc_stats.peak)
+        alloc_stats.peak = alloc_stats.live;
+}
+
+static void account_free(void *p)
+{
+    /* blocks allocated before the reset are not accounted for */
+    size_t size = block_size(p);
+    alloc_stats.live = alloc_stats.live > size ? alloc_stats.live - size : 0;
+}
+
+void *counting_malloc(const size_t size)
+{
+    void *p = malloc(size);
+    if (p)
+        account_alloc(p);
+    return p;
+}
+
+void *counting_malloc_aligned(const size_t size)
+{
+    void *p;
+    if (posix_memalign(&p, ALLOC_LINE, size))
+        return NULL;
+    account_alloc(p);
+    return p;
+}
+
+void *counting_realloc(void *chunk, const size_t size)
+{
+    size_t old_live = alloc_stats.live;
+    if (chunk)
+        account_free(chunk);
+    void *p = realloc(chunk, size);
+    if (p) {
+        account_alloc(p);
+    } else if (chunk) {
+        /* realloc failed and left the old block alone */
+        alloc_stats.live = old_live;
+    }
+    return p;
+}
+
+void counting_free(void *chunk)
+{
+    if (chunk)
+        account_free(chunk);
+    free(chunk);
+}
+
+#ifdef WITH_GC
+void *gc_malloc(const size_t size) { return GC_malloc(size); }
+
+void *gc_malloc_aligned(const size_t size)
+{
+    return GC_memalign(ALLOC_LINE, size);
+}
+
+void *gc_realloc(void *chunk, const size_t size)
+{
+    return GC_realloc(chunk, size);
+}
+
+void gc_free(void *chunk) {}
+#endif
+
+/*
+ * Every pool block is preceded by an 8 byte header holding its size class,
+ * so that free and realloc need no lookup. Classes are multiples of
+ * POOL_GRANULE up to POOL_MAX_SIZE; larger blocks come from malloc and are
+ * marked POOL_LARGE. Blocks are 8-byte aligned, which is all the pointer
+ * sized nodes of most products need; see pool_malloc_aligned() for the
+ * others.
+ */
+#define POOL_GRANULE 8
+#define POOL_N_CLASSES (POOL_MAX_SIZE / POOL_GRANULE)
+#define POOL_ARENA_SIZE (1 << 20)
+#define POOL_LARGE 0
+
+static struct {
+    void *free[POOL_N_CLASSES + 1]; /* free lists by size class */
+    char *cursor, *end;             /* unused part of the current arena */
+} pool;
+
+void *pool_malloc(const size_t size)
+{
+    if (size > POOL_MAX_SIZE) {
+        uint64_t *h = (uint64_t *)malloc(sizeof(uint64_t) + size);
+        if (!h)
+            return NULL;
+        *h = POOL_LARGE;
+        return h + 1;
+    }
+    size_t cls = size ? (size + POOL_GRANULE - 1) / POOL_GRANULE : 1;
+    void *p = pool.free[cls];
+    if (p) {
+        pool.free[cls] = *(void **)p;
+        return p;
+    }
+    size_t block = sizeof(uint64_t) + cls * POOL_GRANULE;
+    if ((size_t)(pool.end - pool.cursor) < block) {
+        /* the rest of the old arena is wasted */
+        char *arena = (char *)malloc(POOL_ARENA_SIZE);
+        if (!arena)
+            return NULL;
+        pool.cursor = arena;
+        pool.end = arena + POOL_ARENA_SIZE;
+    }
+    uint64_t *h = (uint64_t *)pool.cursor;
+    pool.cursor += block;
+    *h = cls;
+    return h + 1;
+}
+
+void *pool_realloc(void *chunk, const size_t size)
+{
+    if (!chunk)
+        return pool_malloc(size);
+    uint64_t *h = (uint64_t *)chunk - 1;
+    if (*h == POOL_LARGE && size > POOL_MAX_SIZE) {
+        h = (uint64_t *)realloc(h, sizeof(uint64_t) + size);
+        return h ? h + 1 : NULL;
+    }
+    /* large blocks are larger than any pooled block */
+    size_t old_size = *h == POOL_LARGE ? size : *h * POOL_GRANULE;
+    if (*h != POOL_LARGE && size <= old_size)
+        return chunk;
+    void *p = pool_malloc(size);
+    if (p) {
+        memcpy(p, chunk, old_size < size ? old_size : size);
+        pool_free(chunk);
+    }
+    return p;
+}
+
+void pool_free(void *chunk)
+{
+    if (!chunk)
+        return;
+    uint64_t *h = (uint64_t *)chunk - 1;
+    if (*h == POOL_LARGE) {
+        free(h);
+        return;
+    }
+    *(void **)chunk = pool.free[*h];
+    pool.free[*h] = chunk;
+}
+
+/*
+ * Aligned pool blocks have no header: every size class, a multiple of
+ * ALLOC_LINE, is carved from arenas of its own. The arenas are aligned to
+ * their size and their first line holds the class, which
+ * pool_free_aligned() finds by masking the block's address.
+ */
+#define POOL_N_ALIGNED (POOL_MAX_ALIGNED / ALLOC_LINE)
+
+static struct {
+    void *free[POOL_N_ALIGNED + 1];
+    char *cursor[POOL_N_ALIGNED + 1], *end[POOL_N_ALIGNED + 1];
+} pool_aligned;
+
+void *pool_malloc_aligned(const size_t size)
+{
+    size_t cls = size ? (size + ALLOC_LINE - 1) / ALLOC_LINE : 1;
+    if (cls > POOL_N_ALIGNED)
+        return NULL;
+    void *p = pool_aligned.free[cls];
+    if (p) {
+        pool_aligned.free[cls] = *(void **)p;
+        return p;
+    }
+    size_t block = cls * ALLOC_LINE;
+    if ((size_t)(pool_aligned.end[cls] - pool_aligned.cursor[cls]) < block) {
+        void *arena;
+        if (posix_memalign(&arena, POOL_ARENA_SIZE, POOL_ARENA_SIZE))
+            return NULL;
+        *(size_t *)arena = cls;
+        pool_aligned.cursor[cls] = (char *)arena + ALLOC_LINE;
+        pool_aligned.end[cls] = (char *)arena + POOL_ARENA_SIZE;
+    }
+    p = pool_aligned.cursor[cls];
+    pool_aligned.cursor[cls] += block;
+    return p;
+}
+
+void pool_free_aligned(void *chunk)
+{
+    if (!chunk)
+        return;
+    uintptr_t arena = (uintptr_t)chunk & ~(uintptr_t)(POOL_ARENA_SIZE - 1);
+    size_t cls = *(size_t *)arena;
+    *(void **)chunk = pool_aligned.free[cls];
+    pool_aligned.free[cls] = chunk;
+}
+
+/*
+ * The allocations of products without allocator hooks are counted by
+ * build/libmemcount.so (src/memcount.c), which replaces the malloc family
+ * when it is preloaded. The driver itself keeps the system's malloc, so
+ * that the timed phases do not pay for the counting.
+ */
+static void (*memcount_stop)(void);
+
+int alloc_interpose_start(void)
+{
+    void *self = dlopen(NULL, RTLD_LAZY);
+    if (!self)
+        return -1;
+    void (*start)(struct alloc_stats *) =
+        (void (*)(struct alloc_stats *))dlsym(self, "memcount_start");
+    memcount_stop = (void (*)(void))dlsym(self, "memcount_stop");
+    dlclose(self);
+    if (!start || !memcount_stop)
+        return -1;
+    start(&alloc_stats);
+    return 0;
+}
+
+void alloc_interpose_stop(void)
+{
+    if (memcount_stop)
+        memcount_stop();
+}
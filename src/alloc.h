@@ -0,0 +1,109 @@
+#ifndef ALLOC_H
+#define ALLOC_H
+
+/*
+ * Allocators and memory accounting.
+ *
+ * Backends that take an allocator (libhamt's struct hamt_allocator,
+ * libavl's struct libavl_allocator) are created with one of the allocators
+ * below; all of them have the hamt_allocator signatures.
+ *
+ *   counting  forwards to malloc and keeps track of the bytes a table
+ *             holds, see struct alloc_stats
+ *   gc        Boehm GC (GC_malloc), free is a no-op; only available if
+ *             the driver is built with WITH_GC
+ *   pool      size-class pool: blocks up to POOL_MAX_SIZE bytes are carved
+ *             from large arenas and recycled through per-class free lists,
+ *             memory is never returned to the system
+ *   slab      per-table slab of fixed-size tree nodes, packed without
+ *             headers in a few large chunks; only the libavl trees support
+ *             it, see libavl_alloc.h. Slab-allocated trees can be relaid
+ *             out into a cache-friendly node order (enum layout).
+ *
+ * Products without allocator hooks (glib, hsearch) are measured by
+ * interposing the malloc family with build/libmemcount.so, preloaded into
+ * the driver; glibc only (see alloc_interpose_start()).
+ *
+ * The *_aligned variants return blocks aligned to ALLOC_LINE bytes, for
+ * nodes that are laid out in whole cache lines (bptree); they are freed
+ * with counting_free, gc_free and pool_free_aligned.
+ *
+ * Sizes are the usable sizes of the malloc'ed blocks, i.e. they include
+ * the allocator's rounding but not its per-block headers. Neither the
+ * counters nor the pool are thread-safe: only one thread may allocate at a
+ * time, and the GC allocator may not be used from threads other than the
+ * main thread.
+ */
+
+#include <stddef.h>
+
+enum allocator {
+    ALLOCATOR_DEFAULT = 1 << 0,  /* the product's own default */
+    ALLOCATOR_COUNTING = 1 << 1, /* malloc with accounting */
+    ALLOCATOR_GC = 1 << 2,       /* Boehm GC */
+    ALLOCATOR_POOL = 1 << 3,     /* size-class pool */
+    ALLOCATOR_SLAB = 1 << 4,     /* per-table node slab */
+};
+
+/* The name of an allocator, as used in workload descriptions */
+const char *allocator_name(enum allocator allocator);
+/* Look up an allocator by name; returns 0 on success, -1 on error */
+int allocator_parse(const char *name, enum allocator *allocator);
+/* Initialise the allocator before its first use */
+void allocator_init(enum allocator allocator);
+
+struct alloc_stats {
+    size_t live;     /* bytes currently allocated */
+    size_t peak;     /* maximum of live since the last reset */
+    size_t n_allocs; /* number of allocations since the last reset */
+};
+
+extern struct alloc_stats alloc_stats;
+
+void alloc_stats_reset(void);
+
+/* The alignment of the *_aligned allocators, one cache line */
+#define ALLOC_LINE 64
+
+void *counting_malloc(const size_t size);
+void *counting_malloc_aligned(const size_t size);
+void *counting_realloc(void *chunk, const size_t size);
+void counting_free(void *chunk);
+
+#ifdef WITH_GC
+void *gc_malloc(const size_t size);
+void *gc_malloc_aligned(const size_t size);
+void *gc_realloc(void *chunk, const size_t size);
+void gc_free(void *chunk);
+#endif
+
+#define POOL_MAX_SIZE 512
+#define POOL_MAX_ALIGNED 4096
+
+void *pool_malloc(const size_t size);
+void *pool_realloc(void *chunk, const size_t size);
+void pool_free(void *chunk);
+/* Blocks of up to POOL_MAX_ALIGNED bytes; NULL for larger ones */
+void *pool_malloc_aligned(const size_t size);
+void pool_free_aligned(void *chunk);
+
+/* Node orders a slab-allocated tree can be relaid out in */
+enum layout {
+    LAYOUT_NONE, /* allocation order */
+    LAYOUT_BFS,  /* breadth-first: level by level from the root */
+    LAYOUT_VEB,  /* van Emde Boas: recursively split by height */
+};
+
+const char *layout_name(enum layout layout);
+/* Look up a layout by name; returns 0 on success, -1 on error */
+int layout_parse(const char *name, enum layout *layout);
+
+/*
+ * Account for every heap allocation of the process in alloc_stats until
+ * alloc_interpose_stop(). Returns 0 on success, -1 if
+ * build/libmemcount.so is not preloaded.
+ */
+int alloc_interpose_start(void);
+void alloc_interpose_stop(void);
+
+#endif
@@ -0,0 +1,138 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "../backend.h"
+#include "../libavl_alloc.h"
+#include "avl.h"
+
+static int cmp_eq_int(const void *lhs, const void *rhs, void *avl_param)
+{
+    /* expects lhs and rhs to be pointers to ints */
+    const int *l = (const int *)lhs;
+    const int *r = (const int *)rhs;
+
+    if (*l > *r)
+        return 1;
+    return *l == *r ? 0 : -1;
+}
+
+static int cmp_eq_str(const void *lhs, const void *rhs, void *avl_param)
+{
+    return strcmp((const char *)lhs, (const char *)rhs);
+}
+
+static void *avl_backend_create(enum key_type type, size_t capacity,
+                                enum allocator allocator)
+{
+    struct libavl_allocator *ator =
+        libavl_allocator_for(allocator, &avl_allocator_default,
+                             sizeof(struct avl_node), capacity);
+    return avl_create(type == KEY_STR ? cmp_eq_str : cmp_eq_int, NULL, ator);
+}
+
+static void avl_backend_destroy(void *table)
+{
+    struct libavl_allocator *ator = ((struct avl_table *)table)->avl_alloc;
+    avl_destroy(table, NULL);
+    libavl_allocator_release(ator);
+}
+
+/* avl trees store items, not key/value pairs: the key is the item */
+static void avl_backend_set(void *table, void *key, void *value)
+{
+    avl_insert(table, key);
+}
+
+static const void *avl_backend_get(const void *table, void *key)
+{
+    return avl_find(table, key);
+}
+
+static void avl_backend_get_batch(const void *table, void **keys,
+                                 const void **values, size_t n)
+{
+    const struct avl_table *t = table;
+    libavl_find_batch(t->avl_root, t->avl_compare, t->avl_param, keys, values,
+                      n);
+}
+
+static void avl_backend_remove(void *table, void *key)
+{
+    avl_delete(table, key);
+}
+
+static size_t avl_backend_iterate(const void *table)
+{
+    struct avl_traverser trav;
+    size_t n = 0;
+    /* libavl traversers take a non-const table but do not modify it */
+    for (void *item = avl_t_first(&trav, (struct avl_table *)table); item;
+         item = avl_t_next(&trav)) {
+        n++;
+    }
+    return n;
+}
+
+/*
+ * Position trav at the first item not less than item, like avl_t_find but
+ * for keys that are not in the table. The traverser's stack holds the
+ * ancestors of the current node, i.e. the search path up to the match.
+ */
+static void *avl_t_lower_bound(struct avl_traverser *trav,
+                               struct avl_table *tree, void *item)
+{
+    struct avl_node *match = NULL;
+    size_t match_height = 0;
+    trav->avl_table = tree;
+    trav->avl_height = 0;
+    trav->avl_generation = tree->avl_generation;
+    for (struct avl_node *p = tree->avl_root; p != NULL;) {
+        int cmp = tree->avl_compare(item, p->avl_data, tree->avl_param);
+        if (cmp <= 0) {
+            match = p;
+            match_height = trav->avl_height;
+            if (cmp == 0)
+                break;
+        }
+        trav->avl_stack[trav->avl_height++] = p;
+        p = p->avl_link[cmp > 0];
+    }
+    trav->avl_height = match_height;
+    trav->avl_node = match;
+    return match ? match->avl_data : NULL;
+}
+
+static size_t avl_backend_range(const void *table, void *from,
+                                const void **values, size_t n)
+{
+    struct avl_traverser trav;
+    size_t i = 0;
+    /* libavl traversers take a non-const table but do not modify it */
+    void *item = avl_t_lower_bound(&trav, (struct avl_table *)table, from);
+    for (; item && i < n; item = avl_t_next(&trav)) {
+        values[i++] = item;
+    }
+    return i;
+}
+
+static void avl_backend_relayout(void *table, enum layout layout)
+{
+    struct avl_table *t = table;
+    libavl_relayout(t->avl_alloc, (void **)&t->avl_root, t->avl_count, layout);
+}
+
+const struct backend backend_avl = {
+    .name = "avl",
+    .key_types = KEY_INT | KEY_STR,
+    .allocators = ALLOCATOR_DEFAULT | ALLOCATOR_COUNTING | ALLOCATOR_GC |
+                  ALLOCATOR_POOL | ALLOCATOR_SLAB,
+    .create = avl_backend_create,
+    .destroy = avl_backend_destroy,
+    .set = avl_backend_set,
+    .get = avl_backend_get,
+    .get_batch = avl_backend_get_batch,
+    .remove = avl_backend_remove,
+    .iterate = avl_backend_iterate,
+    .range = avl_backend_range,
+    .relayout = avl_backend_relayout,
+};
@@ -0,0 +1,73 @@
+#ifndef BACKEND_H
+#define BACKEND_H
+
+/*
+ * Benchmark backend interface.
+ *
+ * Every product under test implements this table of operations; the
+ * driver in bench.c runs the identical workload against all of them.
+ * Keys and values are owned by the driver and must outlive the table.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "alloc.h"
+#include "keys.h"
+
+struct backend {
+    const char *name; /* product name as stored in the database */
+    unsigned key_types; /* mask of supported enum key_type values */
+    unsigned allocators; /* mask of supported enum allocator values */
+    /* create a table for at least `capacity` keys of type `type` */
+    void *(*create)(enum key_type type, size_t capacity,
+                    enum allocator allocator);
+    void (*destroy)(void *table);
+    void (*set)(void *table, void *key, void *value);
+    const void *(*get)(const void *table, void *key);
+    /*
+     * optional: look up n keys at once, storing the value of keys[i] (or
+     * NULL) in values[i]; lets the product overlap the cache misses of
+     * independent lookups
+     */
+    void (*get_batch)(const void *table, void **keys, const void **values,
+                      size_t n);
+    /* optional: the hash the product computes for a key of type `type` */
+    uint32_t (*hash)(enum key_type type, const void *key);
+    /* optional: NULL if the product does not support removal */
+    void (*remove)(void *table, void *key);
+    /* optional persistent operations, NULL if not supported */
+    const void *(*pset)(const void *table, void *key, void *value);
+    const void *(*premove)(const void *table, void *key);
+    /* optional: create a table from n key/value pairs in one go */
+    void *(*bulk_load)(enum key_type type, enum allocator allocator,
+                       void **keys, void **values, size_t n);
+    /*
+     * optional: visit every entry with the product's own traversal and
+     * return the number of entries seen
+     */
+    size_t (*iterate)(const void *table);
+    /*
+     * optional, ordered products only: store the values of the first n
+     * keys not less than `from` in values, in key order, and return how
+     * many there were
+     */
+    size_t (*range)(const void *table, void *from, const void **values,
+                    size_t n);
+    /*
+     * optional: move the nodes of a table created with ALLOCATOR_SLAB into
+     * `layout` order, a no-op for other allocators
+     */
+    void (*relayout)(void *table, enum layout layout);
+};
+
+extern const struct backend backend_hamt;
+extern const struct backend backend_glib;
+extern const struct backend backend_hsearch;
+extern const struct backend backend_avl;
+extern const struct backend backend_rb;
+extern const struct backend backend_swiss;
+extern const struct backend backend_bptree;
+extern const struct backend backend_bptree64;
+
+#endif
@@ -0,0 +1,1111 @@
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <uuid/uuid.h>
+
+#include "bench.h"
+#include "env.h"
+#include "stats.h"
+#include "words.h"
+
+/*
+ * Backend registry. Backends are compiled in on demand, see the
+ * BACKENDS variable in the Makefile.
+ */
+static const struct backend *backends[] = {
+#ifdef WITH_HAMT
+    &backend_hamt,
+#endif
+#ifdef WITH_GLIB
+    &backend_glib,
+#endif
+#ifdef WITH_HSEARCH
+    &backend_hsearch,
+#endif
+#ifdef WITH_AVL
+    &backend_avl,
+#endif
+#ifdef WITH_RB
+    &backend_rb,
+#endif
+#ifdef WITH_SWISS
+    &backend_swiss,
+#endif
+#ifdef WITH_BPTREE
+    &backend_bptree,
+    &backend_bptree64,
+#endif
+};
+
+static const size_t n_backends = sizeof(backends) / sizeof(backends[0]);
+
+/*
+ * String keys are reported as separate measurements, e.g. query_str or
+ * query_words, so that they can be compared with the int key numbers.
+ */
+static const char *key_suffix(const struct context *ctx)
+{
+    if (ctx->key_type == KEY_INT)
+        return "";
+    return ctx->w->words ? "_words" : "_str";
+}
+
+/*
+ * Times of the rows of one (phase, scale) run, per measurement and thread
+ * count, for the adaptive repetitions (see the ci workload parameter).
+ */
+struct series {
+    char measurement[64];
+    size_t threads;
+    double *ns;
+    size_t n;
+    size_t cap;
+};
+
+struct rep_log {
+    struct series *series;
+    size_t n;
+    size_t cap;
+};
+
+static void rep_log_add(struct rep_log *log, const char *measurement,
+                        size_t threads, double ns)
+{
+    struct series *s = NULL;
+    for (size_t i = 0; i < log->n && !s; ++i) {
+        if (log->series[i].threads == threads &&
+            strcmp(log->series[i].measurement, measurement) == 0)
+            s = &log->series[i];
+    }
+    if (!s) {
+        if (log->n == log->cap) {
+            log->cap = log->cap ? 2 * log->cap : 8;
+            log->series =
+                realloc(log->series, log->cap * sizeof(struct series));
+        }
+        s = &log->series[log->n++];
+        memset(s, 0, sizeof(struct series));
+        snprintf(s->measurement, sizeof(s->measurement), "%s", measurement);
+        s->threads = threads;
+    }
+    if (s->n == s->cap) {
+        s->cap = s->cap ? 2 * s->cap : 32;
+        s->ns = realloc(s->ns, s->cap * sizeof(double));
+    }
+    s->ns[s->n++] = ns;
+}
+
+/*
+ * Whether the 95% bootstrap CI of the median of every series, after its
+ * warmup, is within `ci` times the median. Needs five steady values.
+ */
+static int rep_log_converged(const struct rep_log *log, double ci)
+{
+    for (size_t i = 0; i < log->n; ++i) {
+        const struct series *s = &log->series[i];
+        struct summary sum;
+        summarize(s->ns, s->n, &sum);
+        if (sum.n < 5 || (sum.ci_hi - sum.ci_lo) / 2.0 > ci * sum.median)
+            return 0;
+    }
+    return 1;
+}
+
+static void rep_log_clear(struct rep_log *log)
+{
+    for (size_t i = 0; i < log->n; ++i) {
+        free(log->series[i].ns);
+    }
+    free(log->series);
+    memset(log, 0, sizeof(struct rep_log));
+}
+
+void print_row(const struct context *ctx, size_t rep, const char *measurement,
+               size_t scale, size_t threads, double ns_per_op,
+               const struct histogram *h, const struct perf_counters *pc,
+               size_t n_ops, const struct alloc_stats *mem)
+{
+    if (ctx->log)
+        rep_log_add(ctx->log, measurement, threads, ns_per_op);
+    printf("%ld,\"%s\",%lu,\"%s%s\",%lu,%lu,%f", ctx->timestamp,
+           ctx->benchmark_id, ctx->rep_base + rep, measurement,
+           key_suffix(ctx), scale, threads, ns_per_op);
+    if (h && h->n > 0) {
+        const double percentiles[] = {50.0, 90.0, 99.0, 99.9, 100.0};
+        for (size_t i = 0; i < 5; ++i) {
+            printf(",%f", hist_percentile(h, percentiles[i]) / ticks_per_nsec());
+        }
+    } else {
+        printf(",,,,,");
+    }
+    for (int i = 0; i < N_PERF_COUNTERS; ++i) {
+        if (pc && pc->fd[i] >= 0)
+            printf(",%f", pc->value[i] / n_ops);
+        else
+            printf(",");
+    }
+    if (mem)
+        printf(",%f,%f,%f", mem->live / (double)n_ops,
+               mem->peak / (double)n_ops, mem->n_allocs / (double)n_ops);
+    else
+        printf(",,,");
+    printf("\n");
+}
+
+void print_result(const struct context *ctx, size_t rep,
+                  const char *measurement, size_t scale,
+                  struct TimeInterval *ti, size_t n_ops,
+                  const struct sampler *s)
+{
+    print_row(ctx, rep, measurement, scale, 1,
+              timer_nsec(ti) / (double)n_ops, s->h, ctx->pc, n_ops, NULL);
+}
+
+void counters_start(const struct context *ctx)
+{
+    if (ctx->pc)
+        perf_counters_start(ctx->pc);
+}
+
+void counters_stop(const struct context *ctx)
+{
+    if (ctx->pc)
+        perf_counters_stop(ctx->pc);
+}
+
+struct keys *create_keys(const struct context *ctx, size_t n, size_t k)
+{
+    if (ctx->w->words)
+        return keys_create_words(n, k);
+    return keys_create(ctx->key_type, n, k);
+}
+
+void *load_table(const struct context *ctx, struct keys *keys, size_t n,
+                 size_t capacity)
+{
+    const struct backend *b = ctx->b;
+    void *t = b->create(keys->type, capacity, ctx->allocator);
+    for (size_t i = 0; i < n; i++) {
+        b->set(t, keys->refs[i], keys->refs[i]);
+    }
+    if (ctx->w->layout != LAYOUT_NONE)
+        b->relayout(t, ctx->w->layout);
+    return t;
+}
+
+/*
+ * The operation loops of the phases run twice per rep: under the timer
+ * and the counters with a NULL sampler, then untimed with the workload's
+ * sampler for the latency percentiles, see struct sampler. Phases that
+ * modify the table repeat the sampled pass on a fresh one.
+ *
+ * Prepare the sampler; returns 0 if the workload samples nothing.
+ */
+static int sampling(const struct context *ctx, struct sampler *s,
+                    struct histogram *h)
+{
+    sampler_init(s, h, ctx->w->latency_sample);
+    return ctx->w->latency_sample != 0;
+}
+
+static inline void get_ops(const struct backend *b, const void *t,
+                           struct keys *keys, size_t n, struct sampler *s)
+{
+    for (size_t j = 0; j < n; j++) {
+        sampler_begin(s);
+        b->get(t, keys->refs[j]);
+        sampler_end(s);
+    }
+}
+
+static inline void set_ops(const struct backend *b, void *t,
+                           struct keys *keys, size_t n, struct sampler *s)
+{
+    for (size_t j = 0; j < n; j++) {
+        sampler_begin(s);
+        b->set(t, keys->refs[j], keys->refs[j]);
+        sampler_end(s);
+    }
+}
+
+static inline void remove_ops(const struct backend *b, void *t,
+                              struct keys *keys, size_t n, struct sampler *s)
+{
+    for (size_t j = 0; j < n; j++) {
+        sampler_begin(s);
+        b->remove(t, keys->refs[j]);
+        sampler_end(s);
+    }
+}
+
+/* A chain of n persistent updates, each on the version before */
+static inline void persistent_ops(const struct backend *b, const void *t,
+                                  struct keys *keys, size_t n, int remove,
+                                  struct sampler *s)
+{
+    const void *ct = t;
+    for (size_t j = 0; j < n; j++) {
+        void *key = keys->refs[j];
+        sampler_begin(s);
+        ct = remove ? b->premove(ct, key) : b->pset(ct, key, key);
+        sampler_end(s);
+    }
+}
+
+static void perf_query(const struct context *ctx, size_t scale)
+{
+    const struct backend *b = ctx->b;
+    struct keys *keys = create_keys(ctx, scale, 0);
+    struct keys *query_keys = create_keys(ctx, scale, 0);
+
+    void *t = load_table(ctx, keys, scale, scale);
+
+    struct TimeInterval ti_query;
+    struct histogram hist;
+    struct sampler sampler;
+    for (size_t i = 0; i < ctx->w->reps; ++i) {
+        keys_shuffle(query_keys);
+        counters_start(ctx);
+        timer_start(&ti_query);
+        get_ops(b, t, query_keys, scale, NULL);
+        timer_stop(&ti_query);
+        counters_stop(ctx);
+        if (sampling(ctx, &sampler, &hist))
+            get_ops(b, t, query_keys, scale, &sampler);
+        print_result(ctx, i, "query", scale, &ti_query, scale,
+                     &sampler);
+    }
+    b->destroy(t);
+    keys_delete(query_keys);
+    keys_delete(keys);
+}
+
+/*
+ * Query throughput through get_batch: the shuffled keys are looked up
+ * `batch` at a time, for every batch size of the workload. Rows are
+ * named query_batch_<size>, times are per key.
+ */
+static void perf_query_batch(const struct context *ctx, size_t scale)
+{
+    const struct backend *b = ctx->b;
+    struct keys *keys = create_keys(ctx, scale, 0);
+    struct keys *query_keys = create_keys(ctx, scale, 0);
+
+    void *t = load_table(ctx, keys, scale, scale);
+
+    struct TimeInterval ti_query;
+    for (size_t k = 0; k < ctx->w->n_batches; ++k) {
+        size_t batch = ctx->w->batches[k];
+        const void **values = malloc(batch * sizeof(void *));
+        char measurement[32];
+        snprintf(measurement, sizeof(measurement), "query_batch_%lu",
+                 batch);
+        for (size_t i = 0; i < ctx->w->reps; ++i) {
+            keys_shuffle(query_keys);
+            counters_start(ctx);
+            timer_start(&ti_query);
+            for (size_t j = 0; j < scale; j += batch) {
+                size_t n = scale - j < batch ? scale - j : batch;
+                b->get_batch(t, query_keys->refs + j, values, n);
+            }
+            timer_stop(&ti_query);
+            counters_stop(ctx);
+            print_row(ctx, i, measurement, scale, 1,
+                      timer_nsec(&ti_query) / (double)scale, NULL, ctx->pc,
+                      scale, NULL);
+        }
+        free(values);
+    }
+    b->destroy(t);
+    keys_delete(query_keys);
+    keys_delete(keys);
+}
+
+/*
+ * Range scans: the values of `range` consecutive keys from a random start
+ * key, for every range length of the workload. A rep runs scale / range
+ * scans, but at least 100, so that short tables still scan enough keys.
+ * Rows are named range_<length>, times and counters are per key visited.
+ */
+static void perf_range(const struct context *ctx, size_t scale)
+{
+    const struct backend *b = ctx->b;
+    struct keys *keys = create_keys(ctx, scale, 0);
+    struct keys *start_keys = create_keys(ctx, scale, 0);
+
+    void *t = load_table(ctx, keys, scale, scale);
+
+    struct TimeInterval ti_range;
+    for (size_t k = 0; k < ctx->w->n_ranges; ++k) {
+        size_t range = ctx->w->ranges[k];
+        size_t n_scans = scale / range < 100 ? 100 : scale / range;
+        const void **values = malloc(range * sizeof(void *));
+        char measurement[32];
+        snprintf(measurement, sizeof(measurement), "range_%lu", range);
+        for (size_t i = 0; i < ctx->w->reps; ++i) {
+            size_t visited = 0;
+            keys_shuffle(start_keys);
+            counters_start(ctx);
+            timer_start(&ti_range);
+            for (size_t j = 0; j < n_scans; j++) {
+                visited +=
+                    b->range(t, start_keys->refs[j % scale], values, range);
+            }
+            timer_stop(&ti_range);
+            counters_stop(ctx);
+            print_row(ctx, i, measurement, scale, 1,
+                      timer_nsec(&ti_range) / (double)visited, NULL, ctx->pc,
+                      visited, NULL);
+        }
+        free(values);
+    }
+    b->destroy(t);
+    keys_delete(start_keys);
+    keys_delete(keys);
+}
+
+static void perf_insert(const struct context *ctx, size_t scale)
+{
+    const struct backend *b = ctx->b;
+    size_t n_insert = ctx->w->update_fraction * scale;
+    struct keys *keys = create_keys(ctx, scale, 0);
+    struct keys *new_keys = create_keys(ctx, n_insert, scale);
+
+    struct TimeInterval ti_insert;
+    struct histogram hist;
+    struct sampler sampler;
+    for (size_t i = 0; i < ctx->w->reps; ++i) {
+        void *t = load_table(ctx, keys, scale, scale + n_insert);
+        keys_shuffle(new_keys);
+
+        counters_start(ctx);
+        timer_start(&ti_insert);
+        set_ops(b, t, new_keys, n_insert, NULL);
+        timer_stop(&ti_insert);
+        counters_stop(ctx);
+        b->destroy(t);
+        if (sampling(ctx, &sampler, &hist)) {
+            t = load_table(ctx, keys, scale, scale + n_insert);
+            set_ops(b, t, new_keys, n_insert, &sampler);
+            b->destroy(t);
+        }
+        print_result(ctx, i, "insert", scale, &ti_insert, n_insert,
+                     &sampler);
+    }
+    keys_delete(new_keys);
+    keys_delete(keys);
+}
+
+static void perf_remove(const struct context *ctx, size_t scale)
+{
+    const struct backend *b = ctx->b;
+    size_t n_remove = ctx->w->update_fraction * scale;
+    struct keys *keys = create_keys(ctx, scale, 0);
+    struct keys *rem_keys = create_keys(ctx, scale, 0);
+
+    struct TimeInterval ti_remove;
+    struct histogram hist;
+    struct sampler sampler;
+    for (size_t i = 0; i < ctx->w->reps; ++i) {
+        void *t = load_table(ctx, keys, scale, scale);
+        keys_shuffle(rem_keys);
+
+        /* delete the first n_remove entries */
+        counters_start(ctx);
+        timer_start(&ti_remove);
+        remove_ops(b, t, rem_keys, n_remove, NULL);
+        timer_stop(&ti_remove);
+        counters_stop(ctx);
+        b->destroy(t);
+        if (sampling(ctx, &sampler, &hist)) {
+            t = load_table(ctx, keys, scale, scale);
+            remove_ops(b, t, rem_keys, n_remove, &sampler);
+            b->destroy(t);
+        }
+        print_result(ctx, i, "remove", scale, &ti_remove, n_remove,
+                     &sampler);
+    }
+    keys_delete(rem_keys);
+    keys_delete(keys);
+}
+
+/*
+ * Bytes allocated per persistent update: replay the updates of a timed
+ * loop on a table created through the counting allocator, outside the
+ * timer so that the times stay comparable with other allocators. Since
+ * superseded versions are not freed, the live bytes are everything the
+ * updates allocated. Returns 0 and leaves mem alone for products without
+ * allocator hooks or when the workload selects another allocator.
+ */
+static int persistent_bytes(const struct context *ctx, struct keys *keys,
+                            size_t scale, size_t capacity,
+                            struct keys *update_keys, size_t n, int remove,
+                            struct alloc_stats *mem)
+{
+    const struct backend *b = ctx->b;
+    if (ctx->allocator != ALLOCATOR_DEFAULT ||
+        !(b->allocators & ALLOCATOR_COUNTING))
+        return 0;
+    struct context mem_ctx = *ctx;
+    mem_ctx.allocator = ALLOCATOR_COUNTING;
+    void *t = load_table(&mem_ctx, keys, scale, capacity);
+
+    struct alloc_stats before = alloc_stats;
+    alloc_stats.peak = alloc_stats.live;
+    persistent_ops(b, t, update_keys, n, remove, NULL);
+    mem->live = alloc_stats.live - before.live;
+    mem->peak = alloc_stats.peak - before.live;
+    mem->n_allocs = alloc_stats.n_allocs - before.n_allocs;
+    b->destroy(t);
+    return 1;
+}
+
+static void perf_persistent_insert(const struct context *ctx, size_t scale)
+{
+    const struct backend *b = ctx->b;
+    size_t n_insert = ctx->w->update_fraction * scale;
+    struct keys *keys = create_keys(ctx, scale, 0);
+    struct keys *new_keys = create_keys(ctx, n_insert, scale);
+
+    struct TimeInterval ti_insert;
+    struct histogram hist;
+    struct sampler sampler;
+    for (size_t i = 0; i < ctx->w->reps; ++i) {
+        void *t = load_table(ctx, keys, scale, scale + n_insert);
+        keys_shuffle(new_keys);
+
+        counters_start(ctx);
+        timer_start(&ti_insert);
+        persistent_ops(b, t, new_keys, n_insert, 0, NULL);
+        timer_stop(&ti_insert);
+        counters_stop(ctx);
+        b->destroy(t);
+        if (sampling(ctx, &sampler, &hist)) {
+            t = load_table(ctx, keys, scale, scale + n_insert);
+            persistent_ops(b, t, new_keys, n_insert, 0, &sampler);
+            b->destroy(t);
+        }
+        struct alloc_stats mem;
+        int counted = persistent_bytes(ctx, keys, scale, scale + n_insert,
+                                       new_keys, n_insert, 0, &mem);
+        print_row(ctx, i, "persistent_insert", scale, 1,
+                  timer_nsec(&ti_insert) / (double)n_insert, sampler.h,
+                  ctx->pc, n_insert, counted ? &mem : NULL);
+    }
+    keys_delete(new_keys);
+    keys_delete(keys);
+}
+
+static void perf_persistent_remove(const struct context *ctx, size_t scale)
+{
+    const struct backend *b = ctx->b;
+    size_t n_remove = ctx->w->update_fraction * scale;
+    struct keys *keys = create_keys(ctx, scale, 0);
+    struct keys *rem_keys = create_keys(ctx, scale, 0);
+
+    struct TimeInterval ti_remove;
+    struct histogram hist;
+    struct sampler sampler;
+    for (size_t i = 0; i < ctx->w->reps; ++i) {
+        void *t = load_table(ctx, keys, scale, scale);
+        keys_shuffle(rem_keys);
+
+        counters_start(ctx);
+        timer_start(&ti_remove);
+        persistent_ops(b, t, rem_keys, n_remove, 1, NULL);
+        timer_stop(&ti_remove);
+        counters_stop(ctx);
+        b->destroy(t);
+        if (sampling(ctx, &sampler, &hist)) {
+            t = load_table(ctx, keys, scale, scale);
+            persistent_ops(b, t, rem_keys, n_remove, 1, &sampler);
+            b->destroy(t);
+        }
+        struct alloc_stats mem;
+        int counted = persistent_bytes(ctx, keys, scale, scale, rem_keys,
+                                       n_remove, 1, &mem);
+        print_row(ctx, i, "persistent_remove", scale, 1,
+                  timer_nsec(&ti_remove) / (double)n_remove, sampler.h,
+                  ctx->pc, n_remove, counted ? &mem : NULL);
+    }
+    keys_delete(rem_keys);
+    keys_delete(keys);
+}
+
+static inline void mixed_ops(const struct context *ctx, void *t,
+                             struct keys *keys, const struct op *ops,
+                             size_t n_ops, size_t relayout_every,
+                             struct sampler *s)
+{
+    const struct backend *b = ctx->b;
+    for (size_t j = 0; j < n_ops; j++) {
+        void *key = keys->refs[ops[j].key];
+        sampler_begin(s);
+        switch (ops[j].type) {
+        case OP_GET:
+            b->get(t, key);
+            break;
+        case OP_REMOVE:
+            b->remove(t, key);
+            break;
+        default:
+            b->set(t, key, key);
+        }
+        sampler_end(s);
+        if (relayout_every && (j + 1) % relayout_every == 0)
+            b->relayout(t, ctx->w->layout);
+    }
+}
+
+/*
+ * Run a YCSB-style stream of interleaved operations (see generator.h)
+ * against a freshly loaded table and report the mean time per operation.
+ * With a layout and relayout_every set, the table is relaid out every
+ * relayout_every operations and the time per operation includes the
+ * amortised cost.
+ */
+static void perf_mixed(const struct context *ctx, size_t scale)
+{
+    const struct backend *b = ctx->b;
+    const struct mix *mix = &ctx->w->mix;
+    size_t n_ops = mix->n_ops ? mix->n_ops : scale;
+    size_t n_keys = mix_max_keys(mix, scale, n_ops);
+    size_t relayout_every =
+        ctx->w->layout != LAYOUT_NONE ? ctx->w->relayout_every : 0;
+    struct keys *keys = create_keys(ctx, n_keys, 0);
+
+    struct TimeInterval ti_mixed;
+    struct histogram hist;
+    struct sampler sampler;
+    for (size_t i = 0; i < ctx->w->reps; ++i) {
+        void *t = load_table(ctx, keys, scale, n_keys);
+        struct op *ops = generate_ops(mix, scale, n_ops);
+
+        counters_start(ctx);
+        timer_start(&ti_mixed);
+        mixed_ops(ctx, t, keys, ops, n_ops, relayout_every, NULL);
+        timer_stop(&ti_mixed);
+        counters_stop(ctx);
+        b->destroy(t);
+        if (sampling(ctx, &sampler, &hist)) {
+            t = load_table(ctx, keys, scale, n_keys);
+            mixed_ops(ctx, t, keys, ops, n_ops, relayout_every, &sampler);
+            b->destroy(t);
+        }
+        free(ops);
+        print_result(ctx, i, "mixed", scale, &ti_mixed, n_ops,
+                     &sampler);
+    }
+    keys_delete(keys);
+}
+
+/*
+ * Construction throughput: time building a table of `scale` keys from
+ * scratch, once incrementally through set (build) and once through the
+ * backend's bulk loader where it has one (bulk_load).
+ */
+static void perf_build(const struct context *ctx, size_t scale)
+{
+    const struct backend *b = ctx->b;
+    struct keys *keys = create_keys(ctx, scale, 0);
+
+    struct TimeInterval ti_build;
+    struct histogram hist;
+    struct sampler sampler;
+    for (size_t i = 0; i < ctx->w->reps; ++i) {
+        keys_shuffle(keys);
+        counters_start(ctx);
+        timer_start(&ti_build);
+        void *t = b->create(keys->type, scale, ctx->allocator);
+        set_ops(b, t, keys, scale, NULL);
+        timer_stop(&ti_build);
+        counters_stop(ctx);
+        b->destroy(t);
+        if (sampling(ctx, &sampler, &hist)) {
+            t = b->create(keys->type, scale, ctx->allocator);
+            set_ops(b, t, keys, scale, &sampler);
+            b->destroy(t);
+        }
+        print_result(ctx, i, "build", scale, &ti_build, scale, &sampler);
+    }
+    keys_delete(keys);
+}
+
+static void perf_bulk_load(const struct context *ctx, size_t scale)
+{
+    const struct backend *b = ctx->b;
+    struct keys *keys = create_keys(ctx, scale, 0);
+
+    struct TimeInterval ti_build;
+    for (size_t i = 0; i < ctx->w->reps; ++i) {
+        keys_shuffle(keys);
+        counters_start(ctx);
+        timer_start(&ti_build);
+        void *t = b->bulk_load(keys->type, ctx->allocator, keys->refs,
+                               keys->refs, scale);
+        timer_stop(&ti_build);
+        counters_stop(ctx);
+        b->destroy(t);
+        print_row(ctx, i, "bulk_load", scale, 1,
+                  timer_nsec(&ti_build) / (double)scale, NULL, ctx->pc,
+                  scale, NULL);
+    }
+    keys_delete(keys);
+}
+
+/*
+ * Hashing alone: time computing the product's hash of every key, to split
+ * the query time into hashing and traversal.
+ */
+static volatile uint32_t hash_sink;
+
+static void perf_hash(const struct context *ctx, size_t scale)
+{
+    const struct backend *b = ctx->b;
+    struct keys *keys = create_keys(ctx, scale, 0);
+
+    struct TimeInterval ti_hash;
+    for (size_t i = 0; i < ctx->w->reps; ++i) {
+        keys_shuffle(keys);
+        uint32_t sum = 0;
+        counters_start(ctx);
+        timer_start(&ti_hash);
+        for (size_t j = 0; j < scale; j++) {
+            sum += b->hash(keys->type, keys->refs[j]);
+        }
+        timer_stop(&ti_hash);
+        counters_stop(ctx);
+        /* keep the hashes alive */
+        hash_sink = sum;
+        print_row(ctx, i, "hash", scale, 1,
+                  timer_nsec(&ti_hash) / (double)scale, NULL, ctx->pc, scale,
+                  NULL);
+    }
+    keys_delete(keys);
+}
+
+static void time_iterate(const struct context *ctx, size_t rep,
+                         const char *measurement, size_t scale, void *t)
+{
+    struct TimeInterval ti_iterate;
+    counters_start(ctx);
+    timer_start(&ti_iterate);
+    size_t n = ctx->b->iterate(t);
+    timer_stop(&ti_iterate);
+    counters_stop(ctx);
+    if (n != scale) {
+        fprintf(stderr, "%s: iteration visited %lu of %lu entries\n",
+                ctx->b->name, n, scale);
+        exit(1);
+    }
+    print_row(ctx, rep, measurement, scale, 1,
+              timer_nsec(&ti_iterate) / (double)scale, NULL, ctx->pc, scale,
+              NULL);
+}
+
+/*
+ * Full-table scans: time walking every entry of a freshly loaded table
+ * (iterate) and of the same table after half of its keys have been
+ * removed and inserted again in a different order (iterate_churned). The
+ * churn scatters the nodes of node-based products over the heap, which
+ * is what long-lived tables look like. Times and counters are per entry.
+ */
+static void perf_iterate(const struct context *ctx, size_t scale)
+{
+    const struct backend *b = ctx->b;
+    size_t n_churn = scale / 2;
+    struct keys *keys = create_keys(ctx, scale, 0);
+    struct keys *churn_keys = create_keys(ctx, scale, 0);
+
+    for (size_t i = 0; i < ctx->w->reps; ++i) {
+        keys_shuffle(keys);
+        void *t = load_table(ctx, keys, scale, scale);
+        time_iterate(ctx, i, "iterate", scale, t);
+
+        if (b->remove) {
+            keys_shuffle(churn_keys);
+            for (size_t j = 0; j < n_churn; j++) {
+                b->remove(t, churn_keys->refs[j]);
+            }
+            for (size_t j = n_churn; j-- > 0;) {
+                b->set(t, churn_keys->refs[j], churn_keys->refs[j]);
+            }
+            time_iterate(ctx, i, "iterate_churned", scale, t);
+        }
+        b->destroy(t);
+    }
+    keys_delete(churn_keys);
+    keys_delete(keys);
+}
+
+/*
+ * Load a table through the counting allocator, or with malloc interposed
+ * for products without allocator hooks, and report the live bytes, peak
+ * bytes and allocations per key. The time per insert includes the
+ * accounting and is not comparable to the insert phase.
+ */
+static void perf_memory(const struct context *ctx, size_t scale)
+{
+    const struct backend *b = ctx->b;
+    struct keys *keys = create_keys(ctx, scale, 0);
+    struct context mem_ctx = *ctx;
+    int interpose = !(b->allocators & ALLOCATOR_COUNTING);
+    if (!interpose)
+        mem_ctx.allocator = ALLOCATOR_COUNTING;
+
+    struct TimeInterval ti_load;
+    for (size_t i = 0; i < ctx->w->reps; ++i) {
+        alloc_stats_reset();
+        if (interpose && alloc_interpose_start()) {
+            fprintf(stderr,
+                    "%s: cannot count allocations without "
+                    "LD_PRELOAD=build/libmemcount.so\n",
+                    b->name);
+            break;
+        }
+        timer_start(&ti_load);
+        void *t = load_table(&mem_ctx, keys, scale, scale);
+        timer_stop(&ti_load);
+        if (interpose)
+            alloc_interpose_stop();
+        struct alloc_stats mem = alloc_stats;
+        b->destroy(t);
+        print_row(ctx, i, "memory", scale, 1,
+                  timer_nsec(&ti_load) / (double)scale, NULL, NULL, scale,
+                  &mem);
+    }
+    keys_delete(keys);
+}
+
+typedef void perf_func(const struct context *ctx, size_t scale);
+
+static perf_func *perf_funcs[N_PHASES] = {
+    [PHASE_QUERY] = perf_query,
+    [PHASE_INSERT] = perf_insert,
+    [PHASE_REMOVE] = perf_remove,
+    [PHASE_PERSISTENT_INSERT] = perf_persistent_insert,
+    [PHASE_PERSISTENT_REMOVE] = perf_persistent_remove,
+    [PHASE_MIXED] = perf_mixed,
+    [PHASE_PARALLEL_QUERY] = perf_parallel_query,
+    [PHASE_SNAPSHOT] = perf_snapshot,
+    [PHASE_MEMORY] = perf_memory,
+    [PHASE_BUILD] = perf_build,
+    [PHASE_BULK_LOAD] = perf_bulk_load,
+    [PHASE_ITERATE] = perf_iterate,
+    [PHASE_QUERY_BATCH] = perf_query_batch,
+    [PHASE_HASH] = perf_hash,
+    [PHASE_RANGE] = perf_range,
+};
+
+static int phase_supported(const struct backend *b, const struct workload *w,
+                           enum phase phase)
+{
+    switch (phase) {
+    case PHASE_MIXED:
+        return b->remove != NULL || w->mix.ratio[OP_REMOVE] == 0.0;
+    case PHASE_REMOVE:
+        return b->remove != NULL;
+    case PHASE_PERSISTENT_INSERT:
+        return b->pset != NULL;
+    case PHASE_PERSISTENT_REMOVE:
+        return b->premove != NULL;
+    case PHASE_BULK_LOAD:
+        return b->bulk_load != NULL;
+    case PHASE_ITERATE:
+        return b->iterate != NULL;
+    case PHASE_QUERY_BATCH:
+        return b->get_batch != NULL;
+    case PHASE_HASH:
+        return b->hash != NULL;
+    case PHASE_RANGE:
+        return b->range != NULL;
+    case PHASE_SNAPSHOT:
+        /* the collector does not know about the writer thread */
+        return b->pset != NULL && b->premove != NULL &&
+               w->allocator != ALLOCATOR_GC;
+    default:
+        return 1;
+    }
+}
+
+/*
+ * Run a phase in batches of `reps` repetitions until the times of all its
+ * measurements have converged or max_reps repetitions have been run. The
+ * rows of later batches continue the rep numbering.
+ */
+static void run_adaptive(struct context *ctx, enum phase phase, size_t scale)
+{
+    struct rep_log log = {0};
+    int converged = 0;
+    ctx->log = &log;
+    for (ctx->rep_base = 0; ctx->rep_base < ctx->w->max_reps && !converged;
+         ctx->rep_base += ctx->w->reps) {
+        perf_funcs[phase](ctx, scale);
+        fflush(stdout);
+        converged = rep_log_converged(&log, ctx->w->ci);
+    }
+    if (!converged)
+        fprintf(stderr, "%s: %s at scale %lu did not converge in %lu reps\n",
+                ctx->b->name, phase_names[phase], scale, ctx->rep_base);
+    rep_log_clear(&log);
+    ctx->log = NULL;
+    ctx->rep_base = 0;
+}
+
+static const struct backend *find_backend(const char *name)
+{
+    for (size_t i = 0; i < n_backends; ++i) {
+        if (strcmp(backends[i]->name, name) == 0)
+            return backends[i];
+    }
+    return NULL;
+}
+
+/*
+ * Append a CSV row for the experiments table: benchmark id, product,
+ * timestamp, tag, seed, the canonical workload description and the
+ * allocator.
+ */
+static int write_experiment(const char *path, const struct context *ctx)
+{
+    FILE *fp = fopen(path, "a");
+    if (!fp) {
+        fprintf(stderr, "failed to open experiment file: %s\n", path);
+        return -1;
+    }
+    char *workload;
+    size_t len;
+    FILE *ws = open_memstream(&workload, &len);
+    workload_print(ws, ctx->w);
+    fclose(ws);
+
+    fprintf(fp, "\"%s\",\"%s\",%ld,\"", ctx->benchmark_id, ctx->b->name,
+            ctx->timestamp);
+    /* CSV quoting: double any quotes in the free-form fields */
+    for (const char *c = ctx->w->tag; *c; ++c) {
+        fprintf(fp, *c == '"' ? "\"\"" : "%c", *c);
+    }
+    fprintf(fp, "\",%ld,\"", ctx->w->seed);
+    for (const char *c = workload; *c; ++c) {
+        fprintf(fp, *c == '"' ? "\"\"" : "%c", *c);
+    }
+    fprintf(fp, "\",\"%s\"\n", allocator_name(ctx->allocator));
+    free(workload);
+    fclose(fp);
+    return 0;
+}
+
+/* Append a CSV row for the runs table, see src/env.h */
+static int write_run(const char *path, const struct context *ctx)
+{
+    FILE *fp = fopen(path, "a");
+    if (!fp) {
+        fprintf(stderr, "failed to open run file: %s\n", path);
+        return -1;
+    }
+    struct environment env;
+    environment_read(&env);
+    env.allocator = allocator_name(ctx->allocator);
+    environment_print_csv(fp, ctx->benchmark_id, &env);
+    fclose(fp);
+    return 0;
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr,
+            "usage: %s [-w workload] [-o key=value]... [-t tag] [-b id] "
+            "[-e experiments.csv] [-r runs.csv] <backend>\n\n"
+            "  -w FILE        read the workload description from FILE\n"
+            "  -o KEY=VALUE   set a workload parameter (after -w)\n"
+            "  -t TAG         shorthand for -o tag=TAG\n"
+            "  -b UUID        benchmark id, instead of a new one\n"
+            "  -e FILE        append the experiment description to FILE\n"
+            "  -r FILE        append the machine and build description to "
+            "FILE\n"
+            "  -n             print the workload and exit; with a backend, "
+            "after\n"
+            "                 writing the -e and -r rows\n"
+            "\navailable backends:\n",
+            prog);
+    for (size_t i = 0; i < n_backends; ++i) {
+        fprintf(stderr, "  %s\n", backends[i]->name);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    struct workload w;
+    workload_init(&w);
+
+    /*
+     * -o and -t are applied after the workload file so that the command
+     * line always takes precedence, independent of argument order.
+     */
+    const char *workload_path = NULL;
+    const char *experiment_path = NULL;
+    const char *run_path = NULL;
+    const char *benchmark_id = NULL;
+    char **overrides = calloc(argc, sizeof(char *));
+    size_t n_overrides = 0;
+    int dry_run = 0;
+    int opt;
+    while ((opt = getopt(argc, argv, "w:o:t:b:e:r:nh")) != -1) {
+        switch (opt) {
+        case 'w':
+            workload_path = optarg;
+            break;
+        case 'o':
+            overrides[n_overrides++] = strdup(optarg);
+            break;
+        case 't':
+            if (asprintf(&overrides[n_overrides++], "tag=%s", optarg) < 0)
+                return 1;
+            break;
+        case 'b':
+            benchmark_id = optarg;
+            break;
+        case 'e':
+            experiment_path = optarg;
+            break;
+        case 'r':
+            run_path = optarg;
+            break;
+        case 'n':
+            dry_run = 1;
+            break;
+        default:
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (workload_path && workload_load(&w, workload_path))
+        return 1;
+    for (size_t i = 0; i < n_overrides; ++i) {
+        if (workload_parse_line(&w, overrides[i]))
+            return 1;
+        free(overrides[i]);
+    }
+    free(overrides);
+
+    if (dry_run && optind == argc) {
+        workload_print(stdout, &w);
+        return 0;
+    }
+    if (optind != argc - 1) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    struct context ctx;
+    ctx.w = &w;
+    ctx.rep_base = 0;
+    ctx.log = NULL;
+    ctx.b = find_backend(argv[optind]);
+    if (!ctx.b) {
+        fprintf(stderr, "unknown backend: %s\n", argv[optind]);
+        usage(argv[0]);
+        return 1;
+    }
+    ctx.key_type = w.key_type ? w.key_type : ctx.b->key_types & KEY_INT
+                                                 ? KEY_INT
+                                                 : KEY_STR;
+    if (!(ctx.b->key_types & ctx.key_type)) {
+        fprintf(stderr, "backend %s does not support the requested keys\n",
+                ctx.b->name);
+        return 1;
+    }
+    for (size_t i = 0; w.words && i < w.n_scales; ++i) {
+        if (w.scales[i] * (1.0 + w.update_fraction) > WORDS_MAX) {
+            fprintf(stderr, "scale %lu exceeds the %lu words in src/words\n",
+                    w.scales[i], WORDS_MAX);
+            return 1;
+        }
+    }
+    ctx.allocator = w.allocator;
+    if (!(ctx.b->allocators & ctx.allocator)) {
+        fprintf(stderr, "backend %s does not support the %s allocator\n",
+                ctx.b->name, allocator_name(ctx.allocator));
+        return 1;
+    }
+    if (w.layout != LAYOUT_NONE &&
+        (!ctx.b->relayout || ctx.allocator != ALLOCATOR_SLAB)) {
+        fprintf(stderr, "layout %s needs a backend with the slab allocator\n",
+                layout_name(w.layout));
+        return 1;
+    }
+    allocator_init(ctx.allocator);
+    if (hash_int_only(w.hash) && ctx.key_type != KEY_INT) {
+        fprintf(stderr, "hash %s needs int keys\n", hash_name(w.hash));
+        return 1;
+    }
+    hash_select(w.hash);
+
+    /* generate a benchmark id, unless all runs share the given one */
+    uuid_t uuid;
+    if (!benchmark_id) {
+        uuid_generate_random(uuid);
+    } else if (uuid_parse(benchmark_id, uuid)) {
+        fprintf(stderr, "invalid benchmark id: %s\n", benchmark_id);
+        return 1;
+    }
+    uuid_unparse_lower(uuid, ctx.benchmark_id);
+
+    /* get a timestamp */
+    ctx.timestamp = time(0);
+
+    if (experiment_path && write_experiment(experiment_path, &ctx))
+        return 1;
+    if (run_path && write_run(run_path, &ctx))
+        return 1;
+    if (dry_run) {
+        workload_print(stdout, &w);
+        return 0;
+    }
+
+    struct perf_counters pc;
+    ctx.pc = NULL;
+    if (w.counters) {
+        int n_open = perf_counters_open(&pc);
+        if (n_open == 0) {
+            fprintf(stderr, "hardware counters unavailable\n");
+        } else if (n_open < N_PERF_COUNTERS) {
+            fprintf(stderr, "%d of %d hardware counters available:",
+                    n_open, N_PERF_COUNTERS);
+            for (int i = 0; i < N_PERF_COUNTERS; ++i) {
+                if (pc.fd[i] >= 0)
+                    fprintf(stderr, " %s", perf_counter_names[i]);
+            }
+            fprintf(stderr, "\n");
+        }
+        ctx.pc = n_open ? &pc : NULL;
+    }
+
+    /* calibrate the tick counter before anything is timed */
+    timer_calibrate();
+
+    /* run the performance measurements */
+    srand48(w.seed);
+    for (size_t i = 0; i < w.n_phases; ++i) {
+        enum phase phase = w.phases[i];
+        if (!phase_supported(ctx.b, &w, phase)) {
+            fprintf(stderr, "%s: skipping unsupported phase %s\n",
+                    ctx.b->name, phase_names[phase]);
+            continue;
+        }
+        for (size_t j = 0; j < w.n_scales; ++j) {
+            if (w.ci > 0.0)
+                run_adaptive(&ctx, phase, w.scales[j]);
+            else
+                perf_funcs[phase](&ctx, w.scales[j]);
+        }
+    }
+    if (w.counters)
+        perf_counters_close(&pc);
+    return 0;
+}
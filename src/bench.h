@@ -0,0 +1,63 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+/*
+ * Shared state and helpers of the benchmark driver, for phases that are
+ * implemented outside of bench.c.
+ */
+
+#include <stddef.h>
+#include <time.h>
+
+#include "backend.h"
+#include "keys.h"
+#include "perf.h"
+#include "utils.h"
+#include "workload.h"
+
+struct rep_log;
+
+/* Everything a phase needs to know about the current run */
+struct context {
+    const struct backend *b;
+    const struct workload *w;
+    enum key_type key_type;
+    enum allocator allocator; /* for the tables under test */
+    char benchmark_id[37];
+    time_t timestamp;
+    struct perf_counters *pc; /* NULL if counters are disabled */
+    size_t rep_base;      /* added to the rep of every row */
+    struct rep_log *log;  /* collects the times of the rows, or NULL */
+};
+
+/*
+ * Print one row for the numbers table: the mean time per operation and,
+ * if the histogram has samples, the latency percentiles p50, p90, p99,
+ * p99.9 and the maximum, all in ns, followed by the hardware counters per
+ * operation and, if mem is not NULL, the live bytes, peak bytes and
+ * allocations per operation. Missing values are left empty.
+ */
+void print_row(const struct context *ctx, size_t rep, const char *measurement,
+               size_t scale, size_t threads, double ns_per_op,
+               const struct histogram *h, const struct perf_counters *pc,
+               size_t n_ops, const struct alloc_stats *mem);
+/* print_row() for a single-threaded timed loop of n_ops operations */
+void print_result(const struct context *ctx, size_t rep,
+                  const char *measurement, size_t scale,
+                  struct TimeInterval *ti, size_t n_ops,
+                  const struct sampler *s);
+
+void counters_start(const struct context *ctx);
+void counters_stop(const struct context *ctx);
+
+/* Create the keys k, ..., k + n - 1 of the workload's key type */
+struct keys *create_keys(const struct context *ctx, size_t n, size_t k);
+/* Create a table with ctx's allocator and load the first n keys */
+void *load_table(const struct context *ctx, struct keys *keys, size_t n,
+                 size_t capacity);
+
+/* Multi-threaded phases, see parallel.c */
+void perf_parallel_query(const struct context *ctx, size_t scale);
+void perf_snapshot(const struct context *ctx, size_t scale);
+
+#endif
@@ -0,0 +1,146 @@
+#include "../backend.h"
+#include "bptree.h"
+
+/* nodes are laid out in whole cache lines, see bptree.h */
+static struct bptree_allocator bptree_allocator_counting = {
+    counting_malloc_aligned, counting_free};
+
+static struct bptree_allocator bptree_allocator_pool = {pool_malloc_aligned,
+                                                        pool_free_aligned};
+
+#ifdef WITH_GC
+static struct bptree_allocator bptree_allocator_gc = {gc_malloc_aligned,
+                                                      gc_free};
+#endif
+
+static struct bptree_allocator *bptree_allocator_for(enum allocator allocator)
+{
+    switch (allocator) {
+    case ALLOCATOR_COUNTING:
+        return &bptree_allocator_counting;
+    case ALLOCATOR_POOL:
+        return &bptree_allocator_pool;
+#ifdef WITH_GC
+    case ALLOCATOR_GC:
+        return &bptree_allocator_gc;
+#endif
+    default:
+        return &bptree_allocator_default;
+    }
+}
+
+static void *bptree_backend_create(enum key_type type, size_t node_size,
+                                   enum allocator allocator)
+{
+    return bptree_create(type == KEY_STR ? BPTREE_STR : BPTREE_INT,
+                         node_size, bptree_allocator_for(allocator));
+}
+
+/* nodes of four cache lines */
+static void *bptree256_backend_create(enum key_type type, size_t capacity,
+                                      enum allocator allocator)
+{
+    return bptree_backend_create(type, 256, allocator);
+}
+
+/* nodes of one cache line */
+static void *bptree64_backend_create(enum key_type type, size_t capacity,
+                                     enum allocator allocator)
+{
+    return bptree_backend_create(type, 64, allocator);
+}
+
+static void *bptree_backend_bulk_load(enum key_type type, size_t node_size,
+                                      enum allocator allocator, void **keys,
+                                      void **values, size_t n)
+{
+    return bptree_bulk_load(type == KEY_STR ? BPTREE_STR : BPTREE_INT,
+                            node_size, bptree_allocator_for(allocator), keys,
+                            values, n);
+}
+
+static void *bptree256_backend_bulk_load(enum key_type type,
+                                         enum allocator allocator,
+                                         void **keys, void **values, size_t n)
+{
+    return bptree_backend_bulk_load(type, 256, allocator, keys, values, n);
+}
+
+static void *bptree64_backend_bulk_load(enum key_type type,
+                                        enum allocator allocator, void **keys,
+                                        void **values, size_t n)
+{
+    return bptree_backend_bulk_load(type, 64, allocator, keys, values, n);
+}
+
+static void bptree_backend_destroy(void *table) { bptree_delete(table); }
+
+static void bptree_backend_set(void *table, void *key, void *value)
+{
+    bptree_set(table, key, value);
+}
+
+static const void *bptree_backend_get(const void *table, void *key)
+{
+    return bptree_get(table, key);
+}
+
+static void bptree_backend_remove(void *table, void *key)
+{
+    bptree_remove(table, key);
+}
+
+static size_t bptree_backend_iterate(const void *table)
+{
+    struct bptree_cursor cursor;
+    void *value;
+    size_t n = 0;
+    bptree_seek(table, NULL, &cursor);
+    while (bptree_next(&cursor, &value)) {
+        n++;
+    }
+    return n;
+}
+
+static size_t bptree_backend_range(const void *table, void *from,
+                                   const void **values, size_t n)
+{
+    struct bptree_cursor cursor;
+    void *value;
+    size_t i = 0;
+    bptree_seek(table, from, &cursor);
+    while (i < n && bptree_next(&cursor, &value)) {
+        values[i++] = value;
+    }
+    return i;
+}
+
+const struct backend backend_bptree = {
+    .name = "bptree",
+    .key_types = KEY_INT | KEY_STR,
+    .allocators = ALLOCATOR_DEFAULT | ALLOCATOR_COUNTING | ALLOCATOR_GC |
+                  ALLOCATOR_POOL,
+    .create = bptree256_backend_create,
+    .bulk_load = bptree256_backend_bulk_load,
+    .destroy = bptree_backend_destroy,
+    .set = bptree_backend_set,
+    .get = bptree_backend_get,
+    .remove = bptree_backend_remove,
+    .iterate = bptree_backend_iterate,
+    .range = bptree_backend_range,
+};
+
+const struct backend backend_bptree64 = {
+    .name = "bptree64",
+    .key_types = KEY_INT | KEY_STR,
+    .allocators = ALLOCATOR_DEFAULT | ALLOCATOR_COUNTING | ALLOCATOR_GC |
+                  ALLOCATOR_POOL,
+    .create = bptree64_backend_create,
+    .bulk_load = bptree64_backend_bulk_load,
+    .destroy = bptree_backend_destroy,
+    .set = bptree_backend_set,
+    .get = bptree_backend_get,
+    .remove = bptree_backend_remove,
+    .iterate = bptree_backend_iterate,
+    .range = bptree_backend_range,
+};
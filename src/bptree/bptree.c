@@ -0,0 +1,620 @@
+#include "bptree.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define LANES 8
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define LANES 4
+#else
+#define LANES 1
+#endif
+
+#define MIN_NODE 64
+#define MAX_NODE 4096
+
+/*
+ * A node is a header followed by its keys and, 8-byte aligned after them,
+ * its pointers: values in leaves, n + 1 children in inner nodes. Int key
+ * arrays are padded to a multiple of LANES so that the last vector load
+ * stays inside the node.
+ */
+struct node {
+    uint16_t n;
+    uint16_t leaf;
+    uint32_t unused;
+    struct node *next; /* leaves: the next leaf in key order */
+    char data[];
+};
+
+#define HEADER sizeof(struct node)
+/* keys per node are bounded by an int leaf of MAX_NODE bytes */
+#define MAX_KEYS ((MAX_NODE - HEADER) / (sizeof(int32_t) + sizeof(void *)))
+
+struct bptree {
+    struct node *root;
+    size_t size;
+    size_t height;
+    size_t node_size;
+    size_t key_size;
+    unsigned leaf_cap;
+    unsigned inner_cap;
+    size_t leaf_ptrs;  /* offset of the value array in a leaf's data */
+    size_t inner_ptrs; /* offset of the child array in an inner node's data */
+    enum bptree_keys keys;
+    const struct bptree_allocator *ator;
+};
+
+union key {
+    int32_t i;
+    const char *s;
+};
+
+static void *malloc_aligned(const size_t size)
+{
+    void *p;
+    return posix_memalign(&p, 64, size) ? NULL : p;
+}
+
+struct bptree_allocator bptree_allocator_default = {malloc_aligned, free};
+
+static size_t ptrs_offset(enum bptree_keys keys, unsigned cap)
+{
+    if (keys == BPTREE_STR)
+        return cap * sizeof(char *);
+    size_t padded = (cap + LANES - 1) / LANES * LANES;
+    return (padded * sizeof(int32_t) + 7) & ~(size_t)7;
+}
+
+/* the largest number of keys that fits, with `extra` additional pointers */
+static unsigned capacity(enum bptree_keys keys, size_t node_size,
+                         unsigned extra)
+{
+    unsigned cap = 1;
+    while (HEADER + ptrs_offset(keys, cap + 1) +
+               (cap + 1 + extra) * sizeof(void *) <=
+           node_size) {
+        cap++;
+    }
+    return cap;
+}
+
+static inline char *key_addr(const struct bptree *t, const struct node *n,
+                             size_t i)
+{
+    return (char *)n->data + i * t->key_size;
+}
+
+static inline void **ptrs(const struct bptree *t, const struct node *n)
+{
+    return (void **)(n->data + (n->leaf ? t->leaf_ptrs : t->inner_ptrs));
+}
+
+static inline union key load_key(const struct bptree *t, const char *p)
+{
+    union key k;
+    if (t->keys == BPTREE_INT)
+        memcpy(&k.i, p, sizeof(k.i));
+    else
+        memcpy(&k.s, p, sizeof(k.s));
+    return k;
+}
+
+static inline void store_key(const struct bptree *t, char *p, union key k)
+{
+    if (t->keys == BPTREE_INT)
+        memcpy(p, &k.i, sizeof(k.i));
+    else
+        memcpy(p, &k.s, sizeof(k.s));
+}
+
+static inline union key to_key(const struct bptree *t, const void *key)
+{
+    union key k;
+    if (t->keys == BPTREE_INT)
+        k.i = *(const int32_t *)key;
+    else
+        k.s = key;
+    return k;
+}
+
+static inline int key_eq(const struct bptree *t, union key a, union key b)
+{
+    if (t->keys == BPTREE_INT)
+        return a.i == b.i;
+    return strcmp(a.s, b.s) == 0;
+}
+
+/*
+ * Int key search: count the keys less than (or not greater than) k in
+ * one branch-free pass over the node, LANES keys per compare. Keys are
+ * sorted, so the count is the position of k.
+ */
+static inline unsigned count_int(const int32_t *keys, unsigned n, int32_t k,
+                                 int or_equal)
+{
+    unsigned count = 0;
+#if LANES > 1
+    for (unsigned i = 0; i < n; i += LANES) {
+        unsigned bits;
+#if LANES == 8
+        __m256i kk = _mm256_set1_epi32(k);
+        __m256i v = _mm256_loadu_si256((const __m256i *)(keys + i));
+        /* key > k for or_equal, key < k otherwise */
+        __m256i gt = or_equal ? _mm256_cmpgt_epi32(v, kk)
+                              : _mm256_cmpgt_epi32(kk, v);
+        bits = _mm256_movemask_ps(_mm256_castsi256_ps(gt));
+#else
+        __m128i kk = _mm_set1_epi32(k);
+        __m128i v = _mm_loadu_si128((const __m128i *)(keys + i));
+        __m128i gt = or_equal ? _mm_cmpgt_epi32(v, kk) : _mm_cmplt_epi32(v, kk);
+        bits = _mm_movemask_ps(_mm_castsi128_ps(gt));
+#endif
+        if (n - i < LANES)
+            bits &= (1u << (n - i)) - 1;
+        count += __builtin_popcount(bits);
+    }
+    return or_equal ? n - count : count;
+#else
+    for (unsigned i = 0; i < n; ++i) {
+        count += or_equal ? keys[i] <= k : keys[i] < k;
+    }
+    return count;
+#endif
+}
+
+/* String key search: the number of keys less than (or not greater than) k */
+static inline unsigned count_str(const char *const *keys, unsigned n,
+                                 const char *k, int or_equal)
+{
+    unsigned lo = 0, hi = n;
+    while (lo < hi) {
+        unsigned mid = (lo + hi) / 2;
+        int cmp = strcmp(keys[mid], k);
+        if (cmp < 0 || (or_equal && cmp == 0))
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+/* position of the first key not less than k in a leaf */
+static inline unsigned lower_bound(const struct bptree *t,
+                                   const struct node *n, union key k)
+{
+    if (t->keys == BPTREE_INT)
+        return count_int((const int32_t *)n->data, n->n, k.i, 0);
+    return count_str((const char *const *)n->data, n->n, k.s, 0);
+}
+
+/* index of the child of an inner node whose range holds k */
+static inline unsigned child_index(const struct bptree *t,
+                                   const struct node *n, union key k)
+{
+    if (t->keys == BPTREE_INT)
+        return count_int((const int32_t *)n->data, n->n, k.i, 1);
+    return count_str((const char *const *)n->data, n->n, k.s, 1);
+}
+
+static struct node *find_leaf(const struct bptree *t, union key k)
+{
+    struct node *n = t->root;
+    for (size_t h = t->height; h > 1; --h) {
+        n = ptrs(t, n)[child_index(t, n, k)];
+    }
+    return n;
+}
+
+static struct node *node_new(struct bptree *t, int leaf)
+{
+    struct node *n = t->ator->malloc(t->node_size);
+    if (!n)
+        return NULL;
+    /* zeroed, so that the padding lanes of vector loads are defined */
+    memset(n, 0, t->node_size);
+    n->leaf = leaf;
+    return n;
+}
+
+static void node_free(struct bptree *t, struct node *n, size_t height)
+{
+    if (height > 1) {
+        for (unsigned i = 0; i <= n->n; ++i) {
+            node_free(t, ptrs(t, n)[i], height - 1);
+        }
+    }
+    t->ator->free(n);
+}
+
+struct bptree *bptree_create(enum bptree_keys keys, size_t node_size,
+                             const struct bptree_allocator *allocator)
+{
+    if (node_size < MIN_NODE || node_size > MAX_NODE || node_size % 64)
+        return NULL;
+    struct bptree *t = allocator->malloc(sizeof(struct bptree));
+    if (!t)
+        return NULL;
+    t->size = 0;
+    t->height = 1;
+    t->node_size = node_size;
+    t->keys = keys;
+    t->key_size = keys == BPTREE_INT ? sizeof(int32_t) : sizeof(char *);
+    t->leaf_cap = capacity(keys, node_size, 0);
+    t->inner_cap = capacity(keys, node_size, 1);
+    t->leaf_ptrs = ptrs_offset(keys, t->leaf_cap);
+    t->inner_ptrs = ptrs_offset(keys, t->inner_cap);
+    t->ator = allocator;
+    t->root = node_new(t, 1);
+    if (!t->root) {
+        allocator->free(t);
+        return NULL;
+    }
+    return t;
+}
+
+void bptree_delete(struct bptree *tree)
+{
+    node_free(tree, tree->root, tree->height);
+    tree->ator->free(tree);
+}
+
+/*
+ * Insert key (at i) and pointer (at j) into a node's arrays. A full node
+ * is split: its n + 1 keys and pointers are collected in scratch arrays
+ * and dealt out to the node and a new right sibling. Returns the sibling,
+ * the node itself if it had room, or NULL if out of memory.
+ */
+static struct node *node_insert(struct bptree *t, struct node *n, unsigned i,
+                                union key k, unsigned j, void *p,
+                                union key *sep)
+{
+    size_t ks = t->key_size;
+    unsigned n_ptrs = n->leaf ? n->n : n->n + 1u;
+    void **np = ptrs(t, n);
+    unsigned cap = n->leaf ? t->leaf_cap : t->inner_cap;
+    if (n->n < cap) {
+        memmove(key_addr(t, n, i + 1), key_addr(t, n, i), (n->n - i) * ks);
+        memmove(np + j + 1, np + j, (n_ptrs - j) * sizeof(void *));
+        store_key(t, key_addr(t, n, i), k);
+        np[j] = p;
+        n->n++;
+        return n;
+    }
+
+    struct node *r = node_new(t, n->leaf);
+    if (!r)
+        return NULL;
+    char kb[(MAX_KEYS + 1) * sizeof(char *)];
+    void *pb[MAX_KEYS + 2];
+    memcpy(kb, n->data, i * ks);
+    store_key(t, kb + i * ks, k);
+    memcpy(kb + (i + 1) * ks, key_addr(t, n, i), (n->n - i) * ks);
+    memcpy(pb, np, j * sizeof(void *));
+    pb[j] = p;
+    memcpy(pb + j + 1, np + j, (n_ptrs - j) * sizeof(void *));
+
+    unsigned total = n->n + 1;
+    void **rp = ptrs(t, r);
+    if (n->leaf) {
+        /* leaves split evenly, the separator is the right leaf's first key */
+        unsigned left = total - total / 2;
+        n->n = left;
+        r->n = total - left;
+        memcpy(n->data, kb, left * ks);
+        memcpy(np, pb, left * sizeof(void *));
+        memcpy(r->data, kb + left * ks, r->n * ks);
+        memcpy(rp, pb + left, r->n * sizeof(void *));
+        r->next = n->next;
+        n->next = r;
+        *sep = load_key(t, r->data);
+    } else {
+        /* the middle key moves up into the parent */
+        unsigned mid = total / 2;
+        n->n = mid;
+        r->n = total - mid - 1;
+        memcpy(n->data, kb, mid * ks);
+        memcpy(np, pb, (mid + 1) * sizeof(void *));
+        *sep = load_key(t, kb + mid * ks);
+        memcpy(r->data, kb + (mid + 1) * ks, r->n * ks);
+        memcpy(rp, pb + mid + 1, (r->n + 1) * sizeof(void *));
+    }
+    /* clear the vacated slots for the vector loads */
+    memset(key_addr(t, n, n->n), 0, (cap - n->n) * ks);
+    return r;
+}
+
+/*
+ * Insert below n; returns 1 if n was split into n and *right with
+ * separator *sep, 0 if not, and -1 if out of memory.
+ */
+static int insert(struct bptree *t, struct node *n, size_t height,
+                  union key k, void *value, union key *sep,
+                  struct node **right)
+{
+    struct node *r;
+    if (height == 1) {
+        unsigned pos = lower_bound(t, n, k);
+        if (pos < n->n && key_eq(t, load_key(t, key_addr(t, n, pos)), k)) {
+            ptrs(t, n)[pos] = value;
+            return 0;
+        }
+        r = node_insert(t, n, pos, k, pos, value, sep);
+        if (!r)
+            return -1;
+        t->size++;
+    } else {
+        unsigned i = child_index(t, n, k);
+        union key child_sep;
+        struct node *child_right;
+        int rc = insert(t, ptrs(t, n)[i], height - 1, k, value, &child_sep,
+                        &child_right);
+        if (rc <= 0)
+            return rc;
+        r = node_insert(t, n, i, child_sep, i + 1, child_right, sep);
+        if (!r)
+            return -1;
+    }
+    if (r == n)
+        return 0;
+    *right = r;
+    return 1;
+}
+
+int bptree_set(struct bptree *tree, const void *key, void *value)
+{
+    union key sep;
+    struct node *right;
+    int rc = insert(tree, tree->root, tree->height, to_key(tree, key), value,
+                    &sep, &right);
+    if (rc <= 0)
+        return rc;
+    struct node *root = node_new(tree, 0);
+    if (!root)
+        return -1;
+    root->n = 1;
+    store_key(tree, root->data, sep);
+    ptrs(tree, root)[0] = tree->root;
+    ptrs(tree, root)[1] = right;
+    tree->root = root;
+    tree->height++;
+    return 0;
+}
+
+void *bptree_get(const struct bptree *tree, const void *key)
+{
+    union key k = to_key(tree, key);
+    const struct node *leaf = find_leaf(tree, k);
+    unsigned pos = lower_bound(tree, leaf, k);
+    if (pos < leaf->n &&
+        key_eq(tree, load_key(tree, key_addr(tree, leaf, pos)), k))
+        return ptrs(tree, leaf)[pos];
+    return NULL;
+}
+
+int bptree_remove(struct bptree *tree, const void *key)
+{
+    union key k = to_key(tree, key);
+    struct node *leaf = find_leaf(tree, k);
+    unsigned pos = lower_bound(tree, leaf, k);
+    if (pos >= leaf->n ||
+        !key_eq(tree, load_key(tree, key_addr(tree, leaf, pos)), k))
+        return 0;
+    size_t ks = tree->key_size;
+    void **p = ptrs(tree, leaf);
+    leaf->n--;
+    memmove(key_addr(tree, leaf, pos), key_addr(tree, leaf, pos + 1),
+            (leaf->n - pos) * ks);
+    memset(key_addr(tree, leaf, leaf->n), 0, ks);
+    memmove(p + pos, p + pos + 1, (leaf->n - pos) * sizeof(void *));
+    tree->size--;
+    return 1;
+}
+
+size_t bptree_size(const struct bptree *tree) { return tree->size; }
+
+size_t bptree_height(const struct bptree *tree) { return tree->height; }
+
+void bptree_seek(const struct bptree *tree, const void *from,
+                 struct bptree_cursor *cursor)
+{
+    const struct node *leaf;
+    cursor->tree = tree;
+    if (from) {
+        union key k = to_key(tree, from);
+        leaf = find_leaf(tree, k);
+        cursor->pos = lower_bound(tree, leaf, k);
+    } else {
+        leaf = tree->root;
+        for (size_t h = tree->height; h > 1; --h) {
+            leaf = ptrs(tree, leaf)[0];
+        }
+        cursor->pos = 0;
+    }
+    cursor->leaf = leaf;
+}
+
+int bptree_next(struct bptree_cursor *cursor, void **value)
+{
+    const struct node *leaf = cursor->leaf;
+    while (leaf && cursor->pos >= leaf->n) {
+        leaf = leaf->next;
+        cursor->pos = 0;
+        /* scans tend to continue: fetch the leaf after this one */
+        if (leaf && leaf->next)
+            __builtin_prefetch(leaf->next);
+    }
+    cursor->leaf = leaf;
+    if (!leaf)
+        return 0;
+    *value = ptrs(cursor->tree, leaf)[cursor->pos++];
+    return 1;
+}
+
+/*
+ * Bulk loading: the pairs are sorted, dealt out to leaves left to right,
+ * and every inner level is built over the one below, so that no node is
+ * ever split. The nodes of a level share its pairs or children evenly and
+ * are as full as their number allows.
+ */
+struct pair {
+    union key k;
+    void *value;
+    size_t ix; /* input position, so that the last of equal keys wins */
+};
+
+static inline unsigned radix(int32_t k, int shift)
+{
+    return ((uint32_t)k ^ 0x80000000u) >> shift & 0xff;
+}
+
+/*
+ * Int keys: LSD radix sort, one byte per pass. It is stable, so equal
+ * keys stay in input order. Returns -1 if out of memory.
+ */
+static int sort_int(struct pair *pairs, size_t n)
+{
+    struct pair *tmp = malloc(n * sizeof(struct pair));
+    if (!tmp)
+        return -1;
+    struct pair *src = pairs, *dst = tmp;
+    for (int shift = 0; shift < 32; shift += 8) {
+        size_t count[256] = {0};
+        for (size_t i = 0; i < n; ++i) {
+            count[radix(src[i].k.i, shift)]++;
+        }
+        size_t sum = 0;
+        for (int b = 0; b < 256; ++b) {
+            size_t c = count[b];
+            count[b] = sum;
+            sum += c;
+        }
+        for (size_t i = 0; i < n; ++i) {
+            dst[count[radix(src[i].k.i, shift)]++] = src[i];
+        }
+        struct pair *swap = src;
+        src = dst;
+        dst = swap;
+    }
+    /* an even number of passes ends in pairs */
+    free(tmp);
+    return 0;
+}
+
+/* String keys: qsort, equal keys ordered by input position */
+static int pair_cmp_str(const void *a, const void *b)
+{
+    const struct pair *x = a, *y = b;
+    int cmp = strcmp(x->k.s, y->k.s);
+    if (cmp)
+        return cmp;
+    return x->ix < y->ix ? -1 : x->ix > y->ix;
+}
+
+static void level_free(struct bptree *t, struct node **level, size_t n,
+                       size_t height)
+{
+    for (size_t i = 0; i < n; ++i) {
+        node_free(t, level[i], height);
+    }
+}
+
+struct bptree *bptree_bulk_load(enum bptree_keys keys, size_t node_size,
+                                const struct bptree_allocator *allocator,
+                                void **key_ptrs, void **values, size_t n)
+{
+    struct bptree *t = bptree_create(keys, node_size, allocator);
+    if (!t || n == 0)
+        return t;
+    size_t n_leaves = (n + t->leaf_cap - 1) / t->leaf_cap;
+    struct pair *pairs = malloc(n * sizeof(struct pair));
+    /* the nodes of the level being built and their smallest keys */
+    struct node **level = malloc(n_leaves * sizeof(struct node *));
+    union key *mins = malloc(n_leaves * sizeof(union key));
+    if (!pairs || !level || !mins)
+        goto fail;
+
+    for (size_t i = 0; i < n; ++i) {
+        pairs[i].k = to_key(t, key_ptrs[i]);
+        pairs[i].value = values[i];
+        pairs[i].ix = i;
+    }
+    if (keys == BPTREE_STR)
+        qsort(pairs, n, sizeof(struct pair), pair_cmp_str);
+    else if (sort_int(pairs, n))
+        goto fail;
+    size_t m = 0;
+    for (size_t i = 0; i < n; ++i) {
+        if (i + 1 < n && key_eq(t, pairs[i].k, pairs[i + 1].k))
+            continue;
+        pairs[m++] = pairs[i];
+    }
+
+    size_t count = (m + t->leaf_cap - 1) / t->leaf_cap;
+    for (size_t j = 0; j < count; ++j) {
+        size_t lo = m * j / count, hi = m * (j + 1) / count;
+        struct node *leaf = node_new(t, 1);
+        if (!leaf) {
+            level_free(t, level, j, 1);
+            goto fail;
+        }
+        for (size_t i = lo; i < hi; ++i) {
+            store_key(t, key_addr(t, leaf, i - lo), pairs[i].k);
+            ptrs(t, leaf)[i - lo] = pairs[i].value;
+        }
+        leaf->n = hi - lo;
+        if (j > 0)
+            level[j - 1]->next = leaf;
+        level[j] = leaf;
+        mins[j] = pairs[lo].k;
+    }
+
+    /*
+     * Inner levels overwrite the level below in place: node j takes the
+     * children from lo >= j on, which are read before slot j is written.
+     */
+    size_t height = 1;
+    while (count > 1) {
+        size_t fanout = t->inner_cap + 1;
+        size_t up = (count + fanout - 1) / fanout;
+        for (size_t j = 0; j < up; ++j) {
+            size_t lo = count * j / up, hi = count * (j + 1) / up;
+            struct node *inner = node_new(t, 0);
+            if (!inner) {
+                level_free(t, level, j, height + 1);
+                level_free(t, level + lo, count - lo, height);
+                goto fail;
+            }
+            for (size_t i = lo; i < hi; ++i) {
+                ptrs(t, inner)[i - lo] = level[i];
+                if (i > lo)
+                    store_key(t, key_addr(t, inner, i - lo - 1), mins[i]);
+            }
+            inner->n = hi - lo - 1;
+            level[j] = inner;
+            mins[j] = mins[lo];
+        }
+        count = up;
+        height++;
+    }
+
+    node_free(t, t->root, 1);
+    t->root = level[0];
+    t->height = height;
+    t->size = m;
+    free(pairs);
+    free(level);
+    free(mins);
+    return t;
+
+fail:
+    free(pairs);
+    free(level);
+    free(mins);
+    bptree_delete(t);
+    return NULL;
+}
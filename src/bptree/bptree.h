@@ -0,0 +1,76 @@
+#ifndef BPTREE_H
+#define BPTREE_H
+
+/*
+ * B+tree with fixed-size, cache-line sized nodes.
+ *
+ * Every node is `node_size` bytes (a multiple of 64, e.g. one cache line
+ * or four): a small header followed by the node's keys and then its child
+ * or value pointers, so that a node is searched without touching any
+ * other cache line than its own. Int keys are stored inline as 32-bit
+ * integers and searched four at a time with SSE2 compares; string keys
+ * are stored as pointers and binary searched with strcmp. Leaves are
+ * linked in key order for range scans.
+ *
+ * Removal takes the key out of its leaf and does not merge underfull
+ * nodes, as in many database B+trees: a tree keeps its height when it
+ * shrinks, and an emptied leaf stays in the leaf list.
+ *
+ * Keys and values are owned by the caller.
+ */
+
+#include <stddef.h>
+
+enum bptree_keys { BPTREE_INT, BPTREE_STR };
+
+/* malloc must return 64-byte aligned blocks, so that nodes fill lines */
+struct bptree_allocator {
+    void *(*malloc)(const size_t size);
+    void (*free)(void *chunk);
+};
+
+/* 64-byte aligned nodes */
+extern struct bptree_allocator bptree_allocator_default;
+
+struct bptree;
+
+/* Create a tree of nodes of `node_size` bytes, at least 64 */
+struct bptree *bptree_create(enum bptree_keys keys, size_t node_size,
+                             const struct bptree_allocator *allocator);
+void bptree_delete(struct bptree *tree);
+/*
+ * Create a tree of the n keys in key_ptrs and their values in one go,
+ * bottom-up from the sorted keys, without splitting nodes. Of equal keys
+ * the last one wins, as with bptree_set. Returns NULL if out of memory.
+ */
+struct bptree *bptree_bulk_load(enum bptree_keys keys, size_t node_size,
+                                const struct bptree_allocator *allocator,
+                                void **key_ptrs, void **values, size_t n);
+
+/* Insert or replace; returns 0 on success, -1 if out of memory */
+int bptree_set(struct bptree *tree, const void *key, void *value);
+/* The value of key, or NULL */
+void *bptree_get(const struct bptree *tree, const void *key);
+/* Returns 1 if key was removed, 0 if it was not there */
+int bptree_remove(struct bptree *tree, const void *key);
+size_t bptree_size(const struct bptree *tree);
+/* Number of levels, 1 for a tree that is a single leaf */
+size_t bptree_height(const struct bptree *tree);
+
+/*
+ * In-order iteration: bptree_seek positions the cursor at the first key
+ * not less than `from` (the smallest key if `from` is NULL), bptree_next
+ * returns 1 and the value of the key under the cursor and advances it, or
+ * 0 at the end. The tree must not be modified during iteration.
+ */
+struct bptree_cursor {
+    const struct bptree *tree;
+    const void *leaf;
+    size_t pos;
+};
+
+void bptree_seek(const struct bptree *tree, const void *from,
+                 struct bptree_cursor *cursor);
+int bptree_next(struct bptree_cursor *cursor, void **value);
+
+#endif
@@ -0,0 +1,199 @@
+/*
+ * Performance regression gate: compare the benchmark results of two
+ * libhamt commits (or two benchmark runs) in db/db.sqlite.
+ *
+ * The repetitions after the warmup (see the numbers_flagged view) of every
+ * (product, measurement, scale, threads) present on both sides are
+ * compared with the Mann-Whitney U test. A difference is a regression or
+ * an improvement if it is significant at level alpha and the medians
+ * differ by more than the threshold. The exit status is 1 if there is a
+ * regression, so that the tool can gate a libhamt upgrade:
+ *
+ *   build/compare v0.4 v0.5 && echo "no regressions"
+ */
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <sqlite3.h>
+
+#include "stats.h"
+
+static const char *query =
+    "select product, measurement, scale, threads, ns,"
+    "    gitcommit = ?1 or benchmark = ?1 as baseline"
+    " from numbers_flagged"
+    " where not warmup"
+    "    and (gitcommit in (?1, ?2) or benchmark in (?1, ?2))"
+    "    and product like ?3"
+    " order by product, measurement, scale, threads";
+
+struct sample {
+    double *ns;
+    size_t n;
+    size_t cap;
+};
+
+static void sample_add(struct sample *s, double ns)
+{
+    if (s->n == s->cap) {
+        s->cap = s->cap ? 2 * s->cap : 32;
+        s->ns = realloc(s->ns, s->cap * sizeof(double));
+    }
+    s->ns[s->n++] = ns;
+}
+
+struct group {
+    char product[64];
+    char measurement[64];
+    long scale;
+    long threads;
+    struct sample side[2]; /* baseline, candidate */
+};
+
+struct options {
+    double threshold;
+    double alpha;
+};
+
+struct totals {
+    size_t compared;
+    size_t regressions;
+    size_t improvements;
+};
+
+static void compare_group(const struct group *g, const struct options *o,
+                          struct totals *t)
+{
+    const struct sample *a = &g->side[0], *b = &g->side[1];
+    if (a->n == 0 || b->n == 0)
+        return;
+    double median_a = median(a->ns, a->n);
+    double median_b = median(b->ns, b->n);
+    double change = median_a > 0.0 ? median_b / median_a - 1.0 : 0.0;
+    double delta;
+    double p = mann_whitney(a->ns, a->n, b->ns, b->n, &delta);
+    const char *verdict = "";
+    if (p < o->alpha && change > o->threshold) {
+        verdict = "regression";
+        ++t->regressions;
+    } else if (p < o->alpha && change < -o->threshold) {
+        verdict = "improvement";
+        ++t->improvements;
+    }
+    ++t->compared;
+    printf("%-12s %-24s %10ld %7ld %4lu %4lu %10.2f %10.2f %+7.1f%% %8.2g "
+           "%+6.2f  %s\n",
+           g->product, g->measurement, g->scale, g->threads, a->n, b->n,
+           median_a, median_b, 100.0 * change, p, delta, verdict);
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr,
+            "usage: %s [-d db] [-p product] [-t threshold] [-a alpha] "
+            "<baseline> <candidate>\n\n"
+            "Baseline and candidate are gitcommits or benchmark ids.\n\n"
+            "  -d FILE        database (default db/db.sqlite)\n"
+            "  -p PATTERN     products to compare, an SQL like pattern "
+            "(default %%)\n"
+            "  -t FRACTION    change of the median to report (default "
+            "0.05)\n"
+            "  -a ALPHA       significance level (default 0.01)\n"
+            "\nExits with 1 if there is a regression, 2 on errors.\n",
+            prog);
+}
+
+int main(int argc, char **argv)
+{
+    const char *db_path = "db/db.sqlite";
+    const char *products = "%";
+    struct options o = {0.05, 0.01};
+    int opt;
+    while ((opt = getopt(argc, argv, "d:p:t:a:h")) != -1) {
+        switch (opt) {
+        case 'd':
+            db_path = optarg;
+            break;
+        case 'p':
+            products = optarg;
+            break;
+        case 't':
+            o.threshold = atof(optarg);
+            break;
+        case 'a':
+            o.alpha = atof(optarg);
+            break;
+        default:
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if (optind != argc - 2) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    sqlite3 *db;
+    sqlite3_stmt *stmt;
+    if (sqlite3_open_v2(db_path, &db, SQLITE_OPEN_READONLY, NULL) !=
+            SQLITE_OK ||
+        sqlite3_prepare_v2(db, query, -1, &stmt, NULL) != SQLITE_OK) {
+        fprintf(stderr, "%s: %s\n", db_path, sqlite3_errmsg(db));
+        sqlite3_close(db);
+        return 2;
+    }
+    sqlite3_bind_text(stmt, 1, argv[optind], -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 2, argv[optind + 1], -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 3, products, -1, SQLITE_STATIC);
+
+    printf("%-12s %-24s %10s %7s %4s %4s %10s %10s %8s %8s %6s\n", "product",
+           "measurement", "scale", "threads", "n_a", "n_b", "median_a",
+           "median_b", "change", "p", "delta");
+    struct group g = {0};
+    struct totals t = {0};
+    int rc, first = 1;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        const char *product = (const char *)sqlite3_column_text(stmt, 0);
+        const char *measurement = (const char *)sqlite3_column_text(stmt, 1);
+        long scale = sqlite3_column_int64(stmt, 2);
+        long threads = sqlite3_column_int64(stmt, 3);
+        if (first || strcmp(g.product, product) != 0 ||
+            strcmp(g.measurement, measurement) != 0 || g.scale != scale ||
+            g.threads != threads) {
+            if (!first)
+                compare_group(&g, &o, &t);
+            first = 0;
+            snprintf(g.product, sizeof(g.product), "%s", product);
+            snprintf(g.measurement, sizeof(g.measurement), "%s",
+                     measurement);
+            g.scale = scale;
+            g.threads = threads;
+            g.side[0].n = g.side[1].n = 0;
+        }
+        int baseline = sqlite3_column_int(stmt, 5);
+        sample_add(&g.side[!baseline], sqlite3_column_double(stmt, 4));
+    }
+    if (!first)
+        compare_group(&g, &o, &t);
+    if (rc != SQLITE_DONE)
+        fprintf(stderr, "%s: %s\n", db_path, sqlite3_errmsg(db));
+    sqlite3_finalize(stmt);
+    sqlite3_close(db);
+    free(g.side[0].ns);
+    free(g.side[1].ns);
+    if (rc != SQLITE_DONE)
+        return 2;
+
+    printf("\n%lu compared, %lu regressions, %lu improvements "
+           "(threshold %g, alpha %g)\n",
+           t.compared, t.regressions, t.improvements, o.threshold, o.alpha);
+    if (t.compared == 0) {
+        fprintf(stderr, "no measurements in common\n");
+        return 2;
+    }
+    return t.regressions > 0;
+}
@@ -0,0 +1,175 @@
+#define _GNU_SOURCE
+
+#include "env.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <sys/utsname.h>
+#include <unistd.h>
+
+/* set by the Makefile */
+#ifndef BUILD_CFLAGS
+#define BUILD_CFLAGS ""
+#endif
+#ifndef BUILD_COMMIT
+#define BUILD_COMMIT ""
+#endif
+#ifndef HAMT_COMMIT
+#define HAMT_COMMIT ""
+#endif
+
+#if defined(__clang__)
+#define COMPILER "clang " __clang_version__
+#elif defined(__GNUC__)
+#define COMPILER "gcc " __VERSION__
+#else
+#define COMPILER ""
+#endif
+
+/* Read the first line of a file without the newline; "" on failure */
+static void read_line(const char *path, char *buf, size_t size)
+{
+    buf[0] = '\0';
+    FILE *fp = fopen(path, "r");
+    if (!fp)
+        return;
+    if (fgets(buf, size, fp))
+        buf[strcspn(buf, "\n")] = '\0';
+    fclose(fp);
+}
+
+static void read_cpu_model(char *buf, size_t size)
+{
+    char line[512];
+    buf[0] = '\0';
+    FILE *fp = fopen("/proc/cpuinfo", "r");
+    if (!fp)
+        return;
+    while (fgets(line, sizeof(line), fp)) {
+        /* "model name" on x86, "Model" elsewhere */
+        if (strncmp(line, "model name", 10) == 0 ||
+            strncmp(line, "Model", 5) == 0) {
+            char *value = strchr(line, ':');
+            if (value) {
+                value += strspn(value + 1, " \t") + 1;
+                value[strcspn(value, "\n")] = '\0';
+                snprintf(buf, size, "%s", value);
+            }
+            break;
+        }
+    }
+    fclose(fp);
+}
+
+/* sizes in sysfs are given as e.g. "48K" */
+static size_t parse_cache_size(const char *s)
+{
+    char *end;
+    size_t size = strtoul(s, &end, 10);
+    if (*end == 'K')
+        size <<= 10;
+    else if (*end == 'M')
+        size <<= 20;
+    return size;
+}
+
+static void read_caches(size_t cache[4])
+{
+    memset(cache, 0, 4 * sizeof(size_t));
+    for (int i = 0;; ++i) {
+        char path[128], level[16], type[32], size[32];
+        snprintf(path, sizeof(path),
+                 "/sys/devices/system/cpu/cpu0/cache/index%d/level", i);
+        read_line(path, level, sizeof(level));
+        if (!level[0])
+            break;
+        snprintf(path, sizeof(path),
+                 "/sys/devices/system/cpu/cpu0/cache/index%d/type", i);
+        read_line(path, type, sizeof(type));
+        snprintf(path, sizeof(path),
+                 "/sys/devices/system/cpu/cpu0/cache/index%d/size", i);
+        read_line(path, size, sizeof(size));
+        int l = atoi(level);
+        if (l == 1)
+            cache[strcmp(type, "Instruction") == 0] = parse_cache_size(size);
+        else if (l == 2 || l == 3)
+            cache[l] = parse_cache_size(size);
+    }
+}
+
+static void read_turbo(char *buf, size_t size)
+{
+    char value[16];
+    /* intel_pstate inverts the sense */
+    read_line("/sys/devices/system/cpu/intel_pstate/no_turbo", value,
+              sizeof(value));
+    if (value[0]) {
+        snprintf(buf, size, "%s", value[0] == '0' ? "on" : "off");
+        return;
+    }
+    read_line("/sys/devices/system/cpu/cpufreq/boost", value, sizeof(value));
+    if (value[0])
+        snprintf(buf, size, "%s", value[0] == '1' ? "on" : "off");
+    else
+        buf[0] = '\0';
+}
+
+void environment_read(struct environment *env)
+{
+    if (gethostname(env->hostname, sizeof(env->hostname)) != 0)
+        env->hostname[0] = '\0';
+    env->hostname[sizeof(env->hostname) - 1] = '\0';
+    read_cpu_model(env->cpu_model, sizeof(env->cpu_model));
+    env->cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    read_caches(env->cache);
+    read_line("/sys/devices/system/cpu/cpu0/cpufreq/scaling_governor",
+              env->governor, sizeof(env->governor));
+    read_turbo(env->turbo, sizeof(env->turbo));
+    struct utsname u;
+    if (uname(&u) == 0)
+        snprintf(env->kernel, sizeof(env->kernel), "%s %s %s", u.sysname,
+                 u.release, u.machine);
+    else
+        env->kernel[0] = '\0';
+    env->compiler = COMPILER;
+    env->cflags = BUILD_CFLAGS;
+    env->bench_commit = BUILD_COMMIT;
+    env->hamt_commit = HAMT_COMMIT;
+    env->allocator = "";
+}
+
+/* a quoted CSV field, with any quotes doubled */
+static void print_field(FILE *fp, const char *s)
+{
+    fputc('"', fp);
+    for (const char *c = s; *c; ++c) {
+        fprintf(fp, *c == '"' ? "\"\"" : "%c", *c);
+    }
+    fputc('"', fp);
+}
+
+void environment_print_csv(FILE *fp, const char *benchmark_id,
+                           const struct environment *env)
+{
+    print_field(fp, benchmark_id);
+    fputc(',', fp);
+    print_field(fp, env->hostname);
+    fputc(',', fp);
+    print_field(fp, env->cpu_model);
+    fprintf(fp, ",%ld", env->cpus);
+    for (int i = 0; i < 4; ++i) {
+        if (env->cache[i])
+            fprintf(fp, ",%lu", env->cache[i]);
+        else
+            fputc(',', fp);
+    }
+    const char *fields[] = {env->governor, env->turbo,
+                            env->kernel,   env->compiler,
+                            env->cflags,   env->bench_commit,
+                            env->hamt_commit, env->allocator};
+    for (size_t i = 0; i < sizeof(fields) / sizeof(fields[0]); ++i) {
+        fputc(',', fp);
+        print_field(fp, fields[i]);
+    }
+    fputc('\n', fp);
+}
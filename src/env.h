@@ -0,0 +1,38 @@
+#ifndef HAMT_BENCH_ENV
+#define HAMT_BENCH_ENV
+
+/*
+ * The machine and build a benchmark runs on, recorded per run in the runs
+ * table so that results from different hosts, compilers and flags can be
+ * told apart.
+ *
+ * The hardware and kernel settings are read from /proc and sysfs (Linux
+ * only); what cannot be read, e.g. the frequency governor in a VM, is left
+ * empty. The build configuration is compiled in by the Makefile.
+ */
+
+#include <stddef.h>
+#include <stdio.h>
+
+struct environment {
+    char hostname[256];
+    char cpu_model[256];
+    long cpus;            /* online logical CPUs */
+    size_t cache[4];      /* bytes of L1d, L1i, L2, L3, 0 if unknown */
+    char governor[64];    /* cpufreq scaling governor of CPU 0 */
+    char turbo[4];        /* "on", "off" or "" if unknown */
+    char kernel[256];     /* sysname, release and machine */
+    const char *compiler;
+    const char *cflags;
+    const char *bench_commit;
+    const char *hamt_commit;
+    const char *allocator; /* of the tables under test, set by the driver */
+};
+
+/* Everything but the allocator */
+void environment_read(struct environment *env);
+/* Write the CSV row for the runs table, starting with the benchmark id */
+void environment_print_csv(FILE *fp, const char *benchmark_id,
+                           const struct environment *env);
+
+#endif
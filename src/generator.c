@@ -0,0 +1,140 @@
+#include "generator.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+const char *key_dist_names[] = {"uniform", "zipfian", "hotspot", "latest"};
+const char *op_type_names[N_OPS] = {"get", "set", "insert", "remove"};
+
+void mix_init(struct mix *mix)
+{
+    /* read-mostly default, YCSB workload B */
+    mix->ratio[OP_GET] = 95;
+    mix->ratio[OP_SET] = 5;
+    mix->ratio[OP_INSERT] = 0;
+    mix->ratio[OP_REMOVE] = 0;
+    mix->dist = DIST_ZIPFIAN;
+    mix->zipf_theta = 0.99;
+    mix->hot_set = 0.2;
+    mix->hot_ops = 0.8;
+    mix->n_ops = 0;
+}
+
+size_t mix_max_keys(const struct mix *mix, size_t n_keys, size_t n_ops)
+{
+    return mix->ratio[OP_INSERT] > 0 ? n_keys + n_ops : n_keys;
+}
+
+/*
+ * Zipfian rank generator after Gray et al., "Quickly generating
+ * billion-record synthetic databases", SIGMOD 1994, as used by YCSB.
+ */
+struct zipf {
+    size_t n;
+    double theta, alpha, zetan, eta;
+};
+
+static double zeta(size_t n, double theta)
+{
+    double sum = 0.0;
+    for (size_t i = 1; i <= n; ++i) {
+        sum += 1.0 / pow(i, theta);
+    }
+    return sum;
+}
+
+static void zipf_init(struct zipf *z, size_t n, double theta)
+{
+    z->n = n;
+    z->theta = theta;
+    z->alpha = 1.0 / (1.0 - theta);
+    z->zetan = zeta(n, theta);
+    z->eta = (1.0 - pow(2.0 / n, 1.0 - theta)) /
+             (1.0 - zeta(2, theta) / z->zetan);
+}
+
+static size_t zipf_next(const struct zipf *z)
+{
+    double u = drand48();
+    double uz = u * z->zetan;
+    if (uz < 1.0)
+        return 0;
+    if (uz < 1.0 + pow(0.5, z->theta))
+        return 1;
+    size_t rank = z->n * pow(z->eta * u - z->eta + 1.0, z->alpha);
+    return rank < z->n ? rank : z->n - 1;
+}
+
+/* FNV-1a over the rank, used to scatter zipfian ranks over the keys */
+static uint64_t scramble(uint64_t rank)
+{
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (int i = 0; i < 8; ++i) {
+        hash ^= rank & 0xff;
+        hash *= 0x100000001b3ULL;
+        rank >>= 8;
+    }
+    return hash;
+}
+
+static enum op_type next_op(const double *cdf)
+{
+    double u = drand48();
+    for (int i = 0; i < N_OPS - 1; ++i) {
+        if (u < cdf[i])
+            return (enum op_type)i;
+    }
+    return (enum op_type)(N_OPS - 1);
+}
+
+struct op *generate_ops(const struct mix *mix, size_t n_keys, size_t n_ops)
+{
+    struct op *ops = (struct op *)malloc(n_ops * sizeof(struct op));
+    if (!ops || n_keys == 0)
+        return ops;
+
+    double cdf[N_OPS], total = 0.0, acc = 0.0;
+    for (int i = 0; i < N_OPS; ++i) {
+        total += mix->ratio[i];
+    }
+    for (int i = 0; i < N_OPS; ++i) {
+        acc += mix->ratio[i];
+        cdf[i] = acc / total;
+    }
+
+    struct zipf z = {0};
+    if (mix->dist == DIST_ZIPFIAN || mix->dist == DIST_LATEST)
+        zipf_init(&z, n_keys, mix->zipf_theta);
+    size_t n_hot = mix->hot_set * n_keys;
+    if (n_hot == 0)
+        n_hot = 1;
+
+    /* the newest key so far; inserts append after it */
+    size_t n_current = n_keys;
+    for (size_t i = 0; i < n_ops; ++i) {
+        ops[i].type = next_op(cdf);
+        if (ops[i].type == OP_INSERT) {
+            ops[i].key = n_current++;
+            continue;
+        }
+        size_t key;
+        switch (mix->dist) {
+        case DIST_ZIPFIAN:
+            key = scramble(zipf_next(&z)) % n_current;
+            break;
+        case DIST_HOTSPOT:
+            if (drand48() < mix->hot_ops || n_hot == n_current)
+                key = drand48() * n_hot;
+            else
+                key = n_hot + drand48() * (n_current - n_hot);
+            break;
+        case DIST_LATEST:
+            key = n_current - 1 - zipf_next(&z);
+            break;
+        default:
+            key = drand48() * n_current;
+        }
+        ops[i].key = key;
+    }
+    return ops;
+}
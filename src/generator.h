@@ -0,0 +1,53 @@
+#ifndef GENERATOR_H
+#define GENERATOR_H
+
+/*
+ * YCSB-style operation stream generator.
+ *
+ * Generates a stream of get/set/insert/remove operations in configurable
+ * ratios, with keys drawn from one of the YCSB request distributions:
+ *
+ *   uniform  - every loaded key is equally likely
+ *   zipfian  - rank r is drawn with probability ~ 1/r^theta; ranks are
+ *              scrambled over the key space so that hot keys do not
+ *              cluster (YCSB's ScrambledZipfianGenerator)
+ *   hotspot  - hot_ops of the operations go to the first hot_set of the
+ *              key space, the rest to the remaining keys
+ *   latest   - zipfian over recency: the most recently inserted keys are
+ *              the most popular
+ *
+ * Keys are indices into a key set: the first n_keys are loaded before the
+ * stream runs, inserts append new keys n_keys, n_keys + 1, ...
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+enum key_dist { DIST_UNIFORM, DIST_ZIPFIAN, DIST_HOTSPOT, DIST_LATEST };
+
+enum op_type { OP_GET, OP_SET, OP_INSERT, OP_REMOVE, N_OPS };
+
+extern const char *key_dist_names[];
+extern const char *op_type_names[N_OPS];
+
+struct mix {
+    double ratio[N_OPS]; /* relative operation weights */
+    enum key_dist dist;
+    double zipf_theta; /* zipfian/latest skew, 0 < theta < 1 */
+    double hot_set;    /* hotspot: fraction of keys that are hot */
+    double hot_ops;    /* hotspot: fraction of operations on hot keys */
+    size_t n_ops;      /* operations per repetition, 0 means scale */
+};
+
+struct op {
+    uint32_t type;
+    uint32_t key;
+};
+
+void mix_init(struct mix *mix);
+/* Upper bound on the number of keys a stream of n_ops can reference */
+size_t mix_max_keys(const struct mix *mix, size_t n_keys, size_t n_ops);
+/* Generate n_ops operations over n_keys loaded keys; caller frees */
+struct op *generate_ops(const struct mix *mix, size_t n_keys, size_t n_ops);
+
+#endif
@@ -0,0 +1,52 @@
+#include <glib.h>
+
+#include "../backend.h"
+
+static void *glib_create(enum key_type type, size_t capacity,
+                         enum allocator allocator)
+{
+    if (type == KEY_STR)
+        return g_hash_table_new(g_str_hash, g_str_equal);
+    return g_hash_table_new(g_int_hash, g_int_equal);
+}
+
+static void glib_destroy(void *table) { g_hash_table_destroy(table); }
+
+static void glib_set(void *table, void *key, void *value)
+{
+    g_hash_table_insert(table, key, value);
+}
+
+static const void *glib_get(const void *table, void *key)
+{
+    return g_hash_table_lookup((GHashTable *)table, key);
+}
+
+static void glib_remove(void *table, void *key)
+{
+    g_hash_table_remove(table, key);
+}
+
+static void count_entry(gpointer key, gpointer value, gpointer n)
+{
+    *(size_t *)n += value != NULL;
+}
+
+static size_t glib_iterate(const void *table)
+{
+    size_t n = 0;
+    g_hash_table_foreach((GHashTable *)table, count_entry, &n);
+    return n;
+}
+
+const struct backend backend_glib = {
+    .name = "glib2",
+    .key_types = KEY_INT | KEY_STR,
+    .allocators = ALLOCATOR_DEFAULT,
+    .create = glib_create,
+    .destroy = glib_destroy,
+    .set = glib_set,
+    .get = glib_get,
+    .remove = glib_remove,
+    .iterate = glib_iterate,
+};
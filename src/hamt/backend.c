@@ -0,0 +1,153 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../../lib/hamt/include/hamt.h"
+#include "../backend.h"
+#include "../hash.h"
+
+/* libhamt built for a specific instruction set, see HAMT_VARIANTS */
+#ifndef HAMT_PRODUCT
+#define HAMT_PRODUCT "libhamt"
+#endif
+
+static uint32_t my_keyhash_int(const void *key, const size_t gen)
+{
+    return key_hash(key, sizeof(int), gen);
+}
+
+static int my_keycmp_int(const void *lhs, const void *rhs)
+{
+    /* expects lhs and rhs to be pointers to ints */
+    const int *l = (const int *)lhs;
+    const int *r = (const int *)rhs;
+
+    if (*l > *r)
+        return 1;
+    return *l == *r ? 0 : -1;
+}
+
+static uint32_t my_keyhash_string(const void *key, const size_t gen)
+{
+    return key_hash(key, strlen((const char *)key), gen);
+}
+
+static int my_keycmp_string(const void *lhs, const void *rhs)
+{
+    return strcmp((const char *)lhs, (const char *)rhs);
+}
+
+static struct hamt_allocator hamt_allocator_counting = {
+    counting_malloc, counting_realloc, counting_free};
+
+static struct hamt_allocator hamt_allocator_pool = {pool_malloc, pool_realloc,
+                                                    pool_free};
+
+#ifdef WITH_GC
+static struct hamt_allocator hamt_allocator_gc = {gc_malloc, gc_realloc,
+                                                  gc_free};
+#endif
+
+static struct hamt_allocator *hamt_allocator_for(enum allocator allocator)
+{
+    switch (allocator) {
+    case ALLOCATOR_COUNTING:
+        return &hamt_allocator_counting;
+    case ALLOCATOR_POOL:
+        return &hamt_allocator_pool;
+#ifdef WITH_GC
+    case ALLOCATOR_GC:
+        return &hamt_allocator_gc;
+#endif
+    default:
+        return &hamt_allocator_default;
+    }
+}
+
+static void *hamt_backend_create(enum key_type type, size_t capacity,
+                                 enum allocator allocator)
+{
+    if (type == KEY_STR)
+        return hamt_create(my_keyhash_string, my_keycmp_string,
+                           hamt_allocator_for(allocator));
+    return hamt_create(my_keyhash_int, my_keycmp_int,
+                       hamt_allocator_for(allocator));
+}
+
+static void hamt_backend_destroy(void *table) { hamt_delete(table); }
+
+static void hamt_backend_set(void *table, void *key, void *value)
+{
+    hamt_set(table, key, value);
+}
+
+static const void *hamt_backend_get(const void *table, void *key)
+{
+    return hamt_get(table, key);
+}
+
+#ifdef HAVE_HAMT_GET_BATCH
+/*
+ * libhamt walks the lookups of a batch down the trie together, one level
+ * per round, prefetching every lookup's next node before it descends, so
+ * that the cache misses along the root-to-leaf paths overlap.
+ */
+static void hamt_backend_get_batch(const void *table, void **keys,
+                                   const void **values, size_t n)
+{
+    hamt_get_batch(table, keys, values, n);
+}
+#endif
+
+static uint32_t hamt_backend_hash(enum key_type type, const void *key)
+{
+    return type == KEY_STR ? my_keyhash_string(key, 0)
+                           : my_keyhash_int(key, 0);
+}
+
+static void hamt_backend_remove(void *table, void *key)
+{
+    hamt_remove(table, key);
+}
+
+static const void *hamt_backend_pset(const void *table, void *key,
+                                     void *value)
+{
+    return hamt_pset(table, key, value);
+}
+
+static const void *hamt_backend_premove(const void *table, void *key)
+{
+    return hamt_premove(table, key);
+}
+
+static size_t hamt_backend_iterate(const void *table)
+{
+    size_t n = 0;
+    hamt_iterator it = hamt_it_create(table);
+    for (; hamt_it_valid(it); hamt_it_next(it)) {
+        /* load the value so that the walk touches every leaf */
+        n += hamt_it_get_value(it) != NULL;
+    }
+    hamt_it_delete(it);
+    return n;
+}
+
+const struct backend backend_hamt = {
+    .name = HAMT_PRODUCT,
+    .key_types = KEY_INT | KEY_STR,
+    .allocators = ALLOCATOR_DEFAULT | ALLOCATOR_COUNTING | ALLOCATOR_GC |
+                  ALLOCATOR_POOL,
+    .create = hamt_backend_create,
+    .destroy = hamt_backend_destroy,
+    .set = hamt_backend_set,
+    .get = hamt_backend_get,
+#ifdef HAVE_HAMT_GET_BATCH
+    .get_batch = hamt_backend_get_batch,
+#endif
+    .hash = hamt_backend_hash,
+    .remove = hamt_backend_remove,
+    .pset = hamt_backend_pset,
+    .premove = hamt_backend_premove,
+    .iterate = hamt_backend_iterate,
+};
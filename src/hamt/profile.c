@@ -0,0 +1,186 @@
+/*
+ * CPU profiling driver for libhamt.
+ *
+ * Runs the transient insert, persistent insert, query and remove phases
+ * over the word list and profiles each of them into its own gperftools
+ * profile, hamt-<phase>-<uuid>.prof. Table setup and teardown between
+ * repetitions are excluded from the samples, so that hamt_set does not
+ * drown in hamt_create/hamt_delete. The UUID is printed on stdout for
+ * prof.sh, progress and timings go to stderr.
+ *
+ *   usage: profile-hamt [n_words [reps]]
+ *
+ * With the default allocator, the versions created by the persistent
+ * insert phase are leaked; build with GC=1 to collect them.
+ */
+#include <gperftools/profiler.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <uuid/uuid.h>
+
+#include "../../lib/hamt/include/hamt.h"
+#include "../../lib/hamt/include/murmur3.h"
+#include "../alloc.h"
+#include "../utils.h"
+#include "../words.h"
+
+#ifdef WITH_GC
+static struct hamt_allocator hamt_allocator_gc = {gc_malloc, gc_realloc,
+                                                  gc_free};
+#endif
+
+static uint32_t my_keyhash_string(const void *key, const size_t gen)
+{
+    uint32_t hash = murmur3_32((uint8_t *)key, strlen((const char *)key), gen);
+    return hash;
+}
+
+static int my_keycmp_string(const void *lhs, const void *rhs)
+{
+    return strcmp((const char *)lhs, (const char *)rhs);
+}
+
+/* samples are only kept while a phase is running */
+static volatile int in_phase;
+
+static int in_phase_filter(void *arg) { return in_phase; }
+
+struct profile {
+    const char *name;
+    char path[128];
+    struct TimeInterval ti;
+    long nsec;
+    size_t n_ops;
+};
+
+static void profile_start(struct profile *p, const char *name,
+                          const char *uuid)
+{
+    struct ProfilerOptions options = {in_phase_filter, NULL};
+    p->name = name;
+    p->nsec = 0;
+    p->n_ops = 0;
+    snprintf(p->path, sizeof(p->path), "hamt-%s-%s.prof", name, uuid);
+    ProfilerStartWithOptions(p->path, &options);
+}
+
+static void phase_begin(struct profile *p)
+{
+    in_phase = 1;
+    timer_start(&p->ti);
+}
+
+static void phase_end(struct profile *p, size_t n_ops)
+{
+    timer_stop(&p->ti);
+    in_phase = 0;
+    p->nsec += timer_nsec(&p->ti);
+    p->n_ops += n_ops;
+}
+
+static void profile_stop(struct profile *p)
+{
+    ProfilerStop();
+    fprintf(stderr, "%-18s %10.2f ns/op  %s\n", p->name,
+            p->nsec / (double)p->n_ops, p->path);
+}
+
+static struct hamt *load(char **words, size_t n)
+{
+    struct hamt *t = hamt_create(my_keyhash_string, my_keycmp_string,
+                                 &hamt_allocator_default);
+    for (size_t i = 0; i < n; ++i) {
+        hamt_set(t, words[i], words[i]);
+    }
+    return t;
+}
+
+int main(int argc, char **argv)
+{
+    size_t n_words = argc > 1 ? strtoul(argv[1], NULL, 10) : WORDS_MAX;
+    size_t reps = argc > 2 ? strtoul(argv[2], NULL, 10) : 10;
+    if (n_words == 0 || n_words > WORDS_MAX || reps == 0) {
+        fprintf(stderr, "usage: %s [n_words (1..%lu) [reps]]\n", argv[0],
+                WORDS_MAX);
+        return 1;
+    }
+
+    uuid_t uuid;
+    char uuid_str[37];
+    uuid_generate_random(uuid);
+    uuid_unparse_lower(uuid, uuid_str);
+    printf("%s\n", uuid_str);
+    fflush(stdout);
+
+    srand48(time(0));
+    timer_calibrate();
+    char **words;
+    words_load(&words, n_words);
+    char **refs = words_create_shuffled_refs(words, n_words);
+
+    struct profile p;
+    struct hamt *t;
+
+    profile_start(&p, "insert-transient", uuid_str);
+    for (size_t r = 0; r < reps; ++r) {
+        t = hamt_create(my_keyhash_string, my_keycmp_string,
+                        &hamt_allocator_default);
+        phase_begin(&p);
+        for (size_t i = 0; i < n_words; ++i) {
+            hamt_set(t, refs[i], refs[i]);
+        }
+        phase_end(&p, n_words);
+        hamt_delete(t);
+    }
+    profile_stop(&p);
+
+    struct hamt_allocator *ator = &hamt_allocator_default;
+#ifdef WITH_GC
+    allocator_init(ALLOCATOR_GC);
+    ator = &hamt_allocator_gc;
+#endif
+    profile_start(&p, "insert-persistent", uuid_str);
+    for (size_t r = 0; r < reps; ++r) {
+        const struct hamt *ct =
+            hamt_create(my_keyhash_string, my_keycmp_string, ator);
+        phase_begin(&p);
+        for (size_t i = 0; i < n_words; ++i) {
+            ct = hamt_pset(ct, refs[i], refs[i]);
+        }
+        phase_end(&p, n_words);
+    }
+    profile_stop(&p);
+
+    t = load(words, n_words);
+    profile_start(&p, "query", uuid_str);
+    for (size_t r = 0; r < reps; ++r) {
+        char **query = words_create_shuffled_refs(words, n_words);
+        phase_begin(&p);
+        for (size_t i = 0; i < n_words; ++i) {
+            hamt_get(t, query[i]);
+        }
+        phase_end(&p, n_words);
+        words_free_refs(query);
+    }
+    profile_stop(&p);
+    hamt_delete(t);
+
+    profile_start(&p, "remove", uuid_str);
+    for (size_t r = 0; r < reps; ++r) {
+        t = load(words, n_words);
+        phase_begin(&p);
+        for (size_t i = 0; i < n_words; ++i) {
+            hamt_remove(t, refs[i]);
+        }
+        phase_end(&p, n_words);
+        hamt_delete(t);
+    }
+    profile_stop(&p);
+
+    words_free_refs(refs);
+    words_free(words, n_words);
+    return 0;
+}
@@ -0,0 +1,272 @@
+#include "hash.h"
+
+#include <string.h>
+
+#ifdef WITH_XXHASH
+#define XXH_INLINE_ALL
+#include <xxhash.h>
+#endif
+
+#if defined(__x86_64__)
+#include <nmmintrin.h>
+#endif
+
+static const struct {
+    enum hash hash;
+    const char *name;
+    hash_func *func;
+} hashes[] = {
+    {HASH_MURMUR3, "murmur3", hash_murmur3},
+#ifdef WITH_XXHASH
+    {HASH_XXH3, "xxh3", hash_xxh3},
+#endif
+    {HASH_WYHASH, "wyhash", hash_wyhash},
+    {HASH_CRC32C, "crc32c", hash_crc32c},
+    {HASH_FIBONACCI, "fibonacci", hash_fibonacci},
+    {HASH_IDENTITY, "identity", hash_identity},
+};
+
+static const size_t n_hashes = sizeof(hashes) / sizeof(hashes[0]);
+
+hash_func *key_hash = hash_murmur3;
+
+const char *hash_name(enum hash hash)
+{
+    for (size_t i = 0; i < n_hashes; ++i) {
+        if (hashes[i].hash == hash)
+            return hashes[i].name;
+    }
+    return "unknown";
+}
+
+int hash_parse(const char *name, enum hash *hash)
+{
+    for (size_t i = 0; i < n_hashes; ++i) {
+        if (strcmp(hashes[i].name, name) == 0) {
+            *hash = hashes[i].hash;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+int hash_int_only(enum hash hash)
+{
+    return hash == HASH_FIBONACCI || hash == HASH_IDENTITY;
+}
+
+void hash_select(enum hash hash)
+{
+    for (size_t i = 0; i < n_hashes; ++i) {
+        if (hashes[i].hash == hash)
+            key_hash = hashes[i].func;
+    }
+}
+
+/* unaligned little-endian loads; keys are byte strings */
+static inline uint32_t load32(const uint8_t *p)
+{
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline uint64_t load64(const uint8_t *p)
+{
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline uint32_t rotl32(uint32_t x, int r)
+{
+    return (x << r) | (x >> (32 - r));
+}
+
+uint32_t hash_murmur3(const void *key, size_t len, uint32_t seed)
+{
+    const uint8_t *p = key;
+    const uint32_t c1 = 0xcc9e2d51, c2 = 0x1b873593;
+    uint32_t h = seed;
+    size_t n_blocks = len / 4;
+    for (size_t i = 0; i < n_blocks; ++i) {
+        uint32_t k = load32(p + 4 * i);
+        k *= c1;
+        k = rotl32(k, 15);
+        k *= c2;
+        h ^= k;
+        h = rotl32(h, 13);
+        h = h * 5 + 0xe6546b64;
+    }
+    const uint8_t *tail = p + 4 * n_blocks;
+    uint32_t k = 0;
+    switch (len & 3) {
+    case 3:
+        k ^= (uint32_t)tail[2] << 16;
+        /* fall through */
+    case 2:
+        k ^= (uint32_t)tail[1] << 8;
+        /* fall through */
+    case 1:
+        k ^= tail[0];
+        k *= c1;
+        k = rotl32(k, 15);
+        k *= c2;
+        h ^= k;
+    }
+    h ^= (uint32_t)len;
+    h ^= h >> 16;
+    h *= 0x85ebca6b;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35;
+    h ^= h >> 16;
+    return h;
+}
+
+#ifdef WITH_XXHASH
+uint32_t hash_xxh3(const void *key, size_t len, uint32_t seed)
+{
+    uint64_t h = XXH3_64bits_withSeed(key, len, seed);
+    return (uint32_t)(h ^ (h >> 32));
+}
+#endif
+
+/* wyhash, after Wang Yi's reference implementation (final version 4) */
+static const uint64_t wyp[4] = {0xa0761d6478bd642full, 0xe7037ed1a0b428dbull,
+                                0x8ebc6af09c88c6e3ull, 0x589965cc75374cc3ull};
+
+static inline void wymum(uint64_t *a, uint64_t *b)
+{
+    __uint128_t r = (__uint128_t)*a * *b;
+    *a = (uint64_t)r;
+    *b = (uint64_t)(r >> 64);
+}
+
+static inline uint64_t wymix(uint64_t a, uint64_t b)
+{
+    wymum(&a, &b);
+    return a ^ b;
+}
+
+static inline uint64_t wyr3(const uint8_t *p, size_t k)
+{
+    return ((uint64_t)p[0] << 16) | ((uint64_t)p[k >> 1] << 8) | p[k - 1];
+}
+
+uint32_t hash_wyhash(const void *key, size_t len, uint32_t seed)
+{
+    const uint8_t *p = key;
+    uint64_t s = wymix(seed ^ wyp[0], wyp[1]);
+    uint64_t a, b;
+    if (len <= 16) {
+        if (len >= 4) {
+            a = ((uint64_t)load32(p) << 32) | load32(p + ((len >> 3) << 2));
+            b = ((uint64_t)load32(p + len - 4) << 32) |
+                load32(p + len - 4 - ((len >> 3) << 2));
+        } else if (len > 0) {
+            a = wyr3(p, len);
+            b = 0;
+        } else {
+            a = b = 0;
+        }
+    } else {
+        size_t i = len;
+        if (i > 48) {
+            uint64_t s1 = s, s2 = s;
+            do {
+                s = wymix(load64(p) ^ wyp[1], load64(p + 8) ^ s);
+                s1 = wymix(load64(p + 16) ^ wyp[2], load64(p + 24) ^ s1);
+                s2 = wymix(load64(p + 32) ^ wyp[3], load64(p + 40) ^ s2);
+                p += 48;
+                i -= 48;
+            } while (i > 48);
+            s ^= s1 ^ s2;
+        }
+        while (i > 16) {
+            s = wymix(load64(p) ^ wyp[1], load64(p + 8) ^ s);
+            p += 16;
+            i -= 16;
+        }
+        a = load64(p + i - 16);
+        b = load64(p + i - 8);
+    }
+    a ^= wyp[1];
+    b ^= s;
+    wymum(&a, &b);
+    uint64_t h = wymix(a ^ wyp[0] ^ len, b ^ wyp[1]);
+    return (uint32_t)(h ^ (h >> 32));
+}
+
+/* CRC-32C (Castagnoli), reflected polynomial */
+static uint32_t crc32c_table[256];
+static int has_sse42;
+
+/* once at startup, so that the hash path has no initialisation check */
+__attribute__((constructor)) static void crc32c_init(void)
+{
+#if defined(__x86_64__)
+    has_sse42 = __builtin_cpu_supports("sse4.2");
+#endif
+    for (uint32_t i = 0; i < 256; ++i) {
+        uint32_t c = i;
+        for (int j = 0; j < 8; ++j) {
+            c = c & 1 ? (c >> 1) ^ 0x82f63b78 : c >> 1;
+        }
+        crc32c_table[i] = c;
+    }
+}
+
+static uint32_t crc32c_sw(const uint8_t *p, size_t len, uint32_t crc)
+{
+    for (size_t i = 0; i < len; ++i) {
+        crc = crc32c_table[(crc ^ p[i]) & 0xff] ^ (crc >> 8);
+    }
+    return crc;
+}
+
+#if defined(__x86_64__)
+__attribute__((target("sse4.2"))) static uint32_t
+crc32c_hw(const uint8_t *p, size_t len, uint32_t crc)
+{
+    uint64_t c = crc;
+    for (; len >= 8; len -= 8, p += 8) {
+        c = _mm_crc32_u64(c, load64(p));
+    }
+    crc = (uint32_t)c;
+    if (len >= 4) {
+        crc = _mm_crc32_u32(crc, load32(p));
+        len -= 4;
+        p += 4;
+    }
+    for (; len > 0; --len) {
+        crc = _mm_crc32_u8(crc, *p++);
+    }
+    return crc;
+}
+#endif
+
+uint32_t hash_crc32c(const void *key, size_t len, uint32_t seed)
+{
+#if defined(__x86_64__)
+    if (has_sse42)
+        return ~crc32c_hw(key, len, ~seed);
+#endif
+    return ~crc32c_sw(key, len, ~seed);
+}
+
+/*
+ * libhamt consumes the hash from the least significant bits up, so the
+ * Fibonacci hash returns the high half of the 64 bit product, whose low
+ * bits depend on all bits of the key.
+ */
+uint32_t hash_fibonacci(const void *key, size_t len, uint32_t seed)
+{
+    uint64_t x = load32(key) ^ ((uint64_t)seed << 32);
+    return (uint32_t)((x * 0x9e3779b97f4a7c15ull) >> 32);
+}
+
+/* distinct int keys never collide, so the seed is never needed */
+uint32_t hash_identity(const void *key, size_t len, uint32_t seed)
+{
+    return load32(key) ^ seed;
+}
@@ -0,0 +1,55 @@
+#ifndef HASH_H
+#define HASH_H
+
+/*
+ * Hash functions for the products that take one (libhamt), selected per
+ * run with `hash = ...` in the workload:
+ *
+ *   murmur3    MurmurHash3_x86_32, libhamt's default
+ *   xxh3       XXH3_64bits_withSeed, folded to 32 bits; only available if
+ *              the driver is built with WITH_XXHASH (libxxhash)
+ *   wyhash     wyhash, folded to 32 bits
+ *   crc32c     CRC-32C, with the SSE4.2 crc32 instruction where the CPU
+ *              has it and a table otherwise
+ *   fibonacci  Fibonacci (multiplicative) hashing, int keys only
+ *   identity   the key itself, int keys only
+ *
+ * All functions take a seed, which libhamt uses to rehash when it runs
+ * out of hash bits.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+enum hash {
+    HASH_MURMUR3,
+    HASH_XXH3,
+    HASH_WYHASH,
+    HASH_CRC32C,
+    HASH_FIBONACCI,
+    HASH_IDENTITY,
+};
+
+typedef uint32_t hash_func(const void *key, size_t len, uint32_t seed);
+
+/* The name of a hash function, as used in workload descriptions */
+const char *hash_name(enum hash hash);
+/* Look up a hash function by name; returns 0 on success, -1 on error */
+int hash_parse(const char *name, enum hash *hash);
+/* 1 if the hash function only takes 4 byte (int) keys */
+int hash_int_only(enum hash hash);
+
+/* The function the products hash their keys with, murmur3 by default */
+extern hash_func *key_hash;
+void hash_select(enum hash hash);
+
+uint32_t hash_murmur3(const void *key, size_t len, uint32_t seed);
+#ifdef WITH_XXHASH
+uint32_t hash_xxh3(const void *key, size_t len, uint32_t seed);
+#endif
+uint32_t hash_wyhash(const void *key, size_t len, uint32_t seed);
+uint32_t hash_crc32c(const void *key, size_t len, uint32_t seed);
+uint32_t hash_fibonacci(const void *key, size_t len, uint32_t seed);
+uint32_t hash_identity(const void *key, size_t len, uint32_t seed);
+
+#endif
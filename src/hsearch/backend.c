@@ -0,0 +1,64 @@
+#include <search.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../backend.h"
+
+/*
+ * hsearch(3) has hard-coded key and value types:
+ *
+ *   The hsearch() function is a hash-table search routine. [...]
+ *   The item argument is a structure of type ENTRY (defined
+ *   in the <search.h> header) containing two pointers: item.key points to
+ *   the comparison key (a char *), and item.data (a void *) points to any
+ *   other data to be associated with that key.  The comparison function
+ *   used by hsearch() is strcmp(3).
+ *
+ * The backend therefore only accepts string keys. There is a single,
+ * process-wide table, so at most one hsearch table can exist at a time,
+ * and there is no way to remove an entry.
+ *
+ * In terms of memory management: the driver owns the keys. glibc's
+ * hdestroy(3) only releases the table itself and leaves the keys alone.
+ */
+
+static int dummy_table;
+
+static void *hsearch_create(enum key_type type, size_t capacity,
+                            enum allocator allocator)
+{
+    /* make sure we don't need to resize */
+    if (!hcreate(2 * capacity)) {
+        fprintf(stderr, "Failed to create hsearch table.\n");
+        exit(1);
+    }
+    return &dummy_table;
+}
+
+static void hsearch_destroy(void *table) { hdestroy(); }
+
+static void hsearch_set(void *table, void *key, void *value)
+{
+    ENTRY item = {.key = key, .data = value};
+    if (!hsearch(item, ENTER)) {
+        fprintf(stderr, "Failed to insert key: %s.\n", item.key);
+        exit(1);
+    }
+}
+
+static const void *hsearch_get(const void *table, void *key)
+{
+    ENTRY item = {.key = key, .data = NULL};
+    ENTRY *found = hsearch(item, FIND);
+    return found ? found->data : NULL;
+}
+
+const struct backend backend_hsearch = {
+    .name = "hsearch",
+    .key_types = KEY_STR,
+    .allocators = ALLOCATOR_DEFAULT,
+    .create = hsearch_create,
+    .destroy = hsearch_destroy,
+    .set = hsearch_set,
+    .get = hsearch_get,
+};
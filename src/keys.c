@@ -0,0 +1,80 @@
+#define _GNU_SOURCE
+
+#include "keys.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "numbers.h"
+#include "utils.h"
+#include "words.h"
+
+struct keys *keys_create(enum key_type type, const size_t n, const size_t k)
+{
+    struct keys *keys = (struct keys *)malloc(sizeof(struct keys));
+    keys->type = type;
+    keys->n = n;
+    keys->numbers = make_numbers(n, k);
+    keys->refs = (void **)malloc(n * sizeof(void *));
+    for (size_t i = 0; i < n; ++i) {
+        if (type == KEY_INT) {
+            keys->refs[i] = &keys->numbers[i];
+        } else if (asprintf((char **)&keys->refs[i], "%d",
+                            keys->numbers[i]) < 0) {
+            fprintf(stderr, "Failed to allocate string key.\n");
+            exit(1);
+        }
+    }
+    return keys;
+}
+
+struct keys *keys_create_words(const size_t n, const size_t k)
+{
+    if (n + k > WORDS_MAX) {
+        fprintf(stderr, "The word list has only %lu words.\n", WORDS_MAX);
+        exit(1);
+    }
+    char **words;
+    words_load(&words, n + k);
+    struct keys *keys = (struct keys *)malloc(sizeof(struct keys));
+    keys->type = KEY_STR;
+    keys->n = n;
+    keys->numbers = NULL;
+    keys->refs = (void **)malloc(n * sizeof(void *));
+    for (size_t i = 0; i < k; ++i) {
+        free(words[i]);
+    }
+    memcpy(keys->refs, words + k, n * sizeof(void *));
+    free(words);
+    /* the list is sorted, do not insert in order */
+    keys_shuffle(keys);
+    return keys;
+}
+
+/*
+ * Shuffle keys in-place.
+ *
+ * For integer keys we shuffle the backing array and leave the refs in
+ * order: iterating over the refs then reads the key memory sequentially,
+ * just like the original per-product benchmarks did.
+ */
+void keys_shuffle(struct keys *keys)
+{
+    if (keys->type == KEY_INT)
+        shuffle_numbers(keys->numbers, keys->n);
+    else
+        shuffle(keys->refs, keys->n, sizeof(void *));
+}
+
+void keys_delete(struct keys *keys)
+{
+    if (keys->type == KEY_STR) {
+        for (size_t i = 0; i < keys->n; ++i) {
+            free(keys->refs[i]);
+        }
+    }
+    free(keys->refs);
+    free(keys->numbers);
+    free(keys);
+}
@@ -0,0 +1,34 @@
+#ifndef KEYS_H
+#define KEYS_H
+
+/*
+ * Benchmark key sets.
+ *
+ * A key set owns n keys and hands them to the backends as an array of
+ * pointers. Integer keys point into a contiguous int array; string keys
+ * are the decimal representation of the same integers or, for word key
+ * sets, entries of the bundled word list (see words.h).
+ */
+
+#include <stddef.h>
+
+enum key_type {
+    KEY_INT = 1 << 0, /* refs point to int */
+    KEY_STR = 1 << 1, /* refs point to 0-terminated strings */
+};
+
+struct keys {
+    enum key_type type;
+    size_t n;
+    int *numbers; /* backing store for KEY_INT */
+    void **refs;  /* the keys as seen by the backends */
+};
+
+/* Create the keys k, k+1, ..., k + n - 1 */
+struct keys *keys_create(enum key_type type, const size_t n, const size_t k);
+/* Create string keys from the words k, ..., k + n - 1, in random order */
+struct keys *keys_create_words(const size_t n, const size_t k);
+void keys_shuffle(struct keys *keys);
+void keys_delete(struct keys *keys);
+
+#endif
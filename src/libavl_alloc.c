@@ -0,0 +1,338 @@
+#include "libavl_alloc.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* struct libavl_allocator is identical in avl.h and rb.h */
+#include "avl/avl.h"
+
+static void *libavl_counting_malloc(struct libavl_allocator *allocator,
+                                    size_t size)
+{
+    return counting_malloc(size);
+}
+
+static void libavl_counting_free(struct libavl_allocator *allocator,
+                                 void *block)
+{
+    counting_free(block);
+}
+
+static struct libavl_allocator libavl_allocator_counting = {
+    libavl_counting_malloc, libavl_counting_free};
+
+static void *libavl_pool_malloc(struct libavl_allocator *allocator,
+                                size_t size)
+{
+    return pool_malloc(size);
+}
+
+static void libavl_pool_free(struct libavl_allocator *allocator, void *block)
+{
+    pool_free(block);
+}
+
+static struct libavl_allocator libavl_allocator_pool = {libavl_pool_malloc,
+                                                        libavl_pool_free};
+
+#ifdef WITH_GC
+static void *libavl_gc_malloc(struct libavl_allocator *allocator, size_t size)
+{
+    return gc_malloc(size);
+}
+
+static void libavl_gc_free(struct libavl_allocator *allocator, void *block) {}
+
+static struct libavl_allocator libavl_allocator_gc = {libavl_gc_malloc,
+                                                      libavl_gc_free};
+#endif
+
+#define SLAB_MIN_NODES 64
+
+/* Chunks are linked through a header that keeps the nodes cache aligned */
+struct slab_chunk {
+    struct slab_chunk *next;
+    char *begin, *end; /* the nodes */
+    char pad[64 - 3 * sizeof(void *)];
+};
+
+struct slab {
+    struct libavl_allocator base; /* first, so that libavl's pointer is ours */
+    size_t node_size;
+    size_t next_nodes;       /* capacity of the next chunk */
+    struct slab_chunk *chunks;
+    void *free;              /* free list of recycled nodes */
+    char *cursor, *end;      /* unused part of the newest chunk */
+};
+
+static struct slab_chunk *slab_chunk_create(struct slab *s, size_t n_nodes)
+{
+    size_t bytes = sizeof(struct slab_chunk) + n_nodes * s->node_size;
+    struct slab_chunk *c = aligned_alloc(64, (bytes + 63) & ~(size_t)63);
+    if (!c)
+        return NULL;
+    c->begin = (char *)(c + 1);
+    c->end = c->begin + n_nodes * s->node_size;
+    c->next = s->chunks;
+    s->chunks = c;
+    return c;
+}
+
+static void *libavl_slab_malloc(struct libavl_allocator *allocator,
+                                size_t size)
+{
+    struct slab *s = (struct slab *)allocator;
+    if (size != s->node_size)
+        return malloc(size);
+    void *p = s->free;
+    if (p) {
+        s->free = *(void **)p;
+        return p;
+    }
+    if (s->cursor == s->end) {
+        struct slab_chunk *c = slab_chunk_create(s, s->next_nodes);
+        if (!c)
+            return NULL;
+        s->next_nodes *= 2;
+        s->cursor = c->begin;
+        s->end = c->end;
+    }
+    p = s->cursor;
+    s->cursor += s->node_size;
+    return p;
+}
+
+static int slab_owns(const struct slab *s, const void *block)
+{
+    for (const struct slab_chunk *c = s->chunks; c; c = c->next) {
+        if ((const char *)block >= c->begin && (const char *)block < c->end)
+            return 1;
+    }
+    return 0;
+}
+
+static void libavl_slab_free(struct libavl_allocator *allocator, void *block)
+{
+    struct slab *s = (struct slab *)allocator;
+    if (!slab_owns(s, block)) {
+        free(block);
+        return;
+    }
+    *(void **)block = s->free;
+    s->free = block;
+}
+
+static void slab_release_chunks(struct slab *s)
+{
+    while (s->chunks) {
+        struct slab_chunk *c = s->chunks;
+        s->chunks = c->next;
+        free(c);
+    }
+    s->free = NULL;
+    s->cursor = s->end = NULL;
+}
+
+static struct libavl_allocator *slab_create(size_t node_size,
+                                            size_t capacity)
+{
+    struct slab *s = calloc(1, sizeof(struct slab));
+    s->base.libavl_malloc = libavl_slab_malloc;
+    s->base.libavl_free = libavl_slab_free;
+    /* the free list is threaded through the nodes */
+    s->node_size = node_size < sizeof(void *) ? sizeof(void *) : node_size;
+    s->next_nodes = capacity < SLAB_MIN_NODES ? SLAB_MIN_NODES : capacity;
+    return &s->base;
+}
+
+static int is_slab(const struct libavl_allocator *allocator)
+{
+    return allocator->libavl_malloc == libavl_slab_malloc;
+}
+
+void libavl_allocator_release(struct libavl_allocator *allocator)
+{
+    if (!is_slab(allocator))
+        return;
+    slab_release_chunks((struct slab *)allocator);
+    free(allocator);
+}
+
+/* The prefix all libavl nodes share */
+struct node {
+    struct node *link[2];
+    void *data;
+};
+
+static size_t layout_bfs(struct node *root, struct node **order)
+{
+    size_t n = 0;
+    order[n++] = root;
+    for (size_t i = 0; i < n; ++i) {
+        for (int dir = 0; dir < 2; ++dir) {
+            if (order[i]->link[dir])
+                order[n++] = order[i]->link[dir];
+        }
+    }
+    return n;
+}
+
+static int tree_height(const struct node *node)
+{
+    if (!node)
+        return 0;
+    int l = tree_height(node->link[0]);
+    int r = tree_height(node->link[1]);
+    return 1 + (l > r ? l : r);
+}
+
+static void layout_veb(struct node *node, int height, struct node **order,
+                       size_t *n);
+
+/* lay out the subtrees hanging `depth` levels below node, left to right */
+static void layout_veb_bottom(struct node *node, int depth, int height,
+                              struct node **order, size_t *n)
+{
+    if (!node)
+        return;
+    if (depth == 0) {
+        layout_veb(node, height, order, n);
+        return;
+    }
+    layout_veb_bottom(node->link[0], depth - 1, height, order, n);
+    layout_veb_bottom(node->link[1], depth - 1, height, order, n);
+}
+
+/*
+ * Lay out the top `height` levels below node: the upper half of the levels
+ * first, then each of the subtrees below it, recursively. Every subtree of
+ * height 2^k then spans a contiguous block of at most 2^(2^k) nodes.
+ */
+static void layout_veb(struct node *node, int height, struct node **order,
+                       size_t *n)
+{
+    if (!node)
+        return;
+    if (height == 1) {
+        order[(*n)++] = node;
+        return;
+    }
+    int top = height / 2;
+    layout_veb(node, top, order, n);
+    layout_veb_bottom(node, top, height - top, order, n);
+}
+
+void libavl_relayout(struct libavl_allocator *allocator, void **root,
+                     size_t count, enum layout layout)
+{
+    if (!is_slab(allocator) || layout == LAYOUT_NONE || !*root)
+        return;
+    struct slab *s = (struct slab *)allocator;
+    struct node **order = malloc(count * sizeof(struct node *));
+    size_t n = 0;
+    if (layout == LAYOUT_BFS)
+        n = layout_bfs(*root, order);
+    else
+        layout_veb(*root, tree_height(*root), order, &n);
+
+    /* copy, then leave a forwarding address in each old node's left link */
+    struct slab_chunk *old = s->chunks;
+    s->chunks = NULL;
+    struct slab_chunk *c = slab_chunk_create(s, n);
+    s->chunks = old;
+    if (!c) {
+        free(order);
+        return;
+    }
+    for (size_t i = 0; i < n; ++i) {
+        memcpy(c->begin + i * s->node_size, order[i], s->node_size);
+    }
+    for (size_t i = 0; i < n; ++i) {
+        order[i]->link[0] = (struct node *)(c->begin + i * s->node_size);
+    }
+    for (size_t i = 0; i < n; ++i) {
+        struct node *node = (struct node *)(c->begin + i * s->node_size);
+        for (int dir = 0; dir < 2; ++dir) {
+            if (node->link[dir])
+                node->link[dir] = node->link[dir]->link[0];
+        }
+    }
+    *root = ((struct node *)*root)->link[0];
+    free(order);
+
+    /* the old chunks, free list included, are garbage now */
+    slab_release_chunks(s);
+    s->chunks = c;
+    /* the new chunk is full, later nodes go to a fresh one */
+    s->cursor = s->end = c->end;
+}
+
+struct libavl_allocator *
+libavl_allocator_for(enum allocator allocator,
+                     struct libavl_allocator *fallback, size_t node_size,
+                     size_t capacity)
+{
+    switch (allocator) {
+    case ALLOCATOR_COUNTING:
+        return &libavl_allocator_counting;
+    case ALLOCATOR_POOL:
+        return &libavl_allocator_pool;
+    case ALLOCATOR_SLAB:
+        return slab_create(node_size, capacity);
+#ifdef WITH_GC
+    case ALLOCATOR_GC:
+        return &libavl_allocator_gc;
+#endif
+    default:
+        return fallback;
+    }
+}
+
+/*
+ * Up to LIBAVL_BATCH lookups walk down the tree side by side, one level
+ * per round: a round first prefetches the items of all current nodes,
+ * then compares and prefetches the children, so that the misses of one
+ * lookup overlap with those of the others.
+ */
+#define LIBAVL_BATCH 64
+
+void libavl_find_batch(const void *root, libavl_compare_func *compare,
+                       void *param, void **keys, const void **values,
+                       size_t n)
+{
+    const struct node *cur[LIBAVL_BATCH];
+    size_t idx[LIBAVL_BATCH];
+    for (size_t base = 0; base < n; base += LIBAVL_BATCH) {
+        size_t m = n - base < LIBAVL_BATCH ? n - base : LIBAVL_BATCH;
+        size_t active = 0;
+        for (size_t i = 0; i < m; ++i) {
+            values[base + i] = NULL;
+            if (root) {
+                cur[active] = root;
+                idx[active++] = base + i;
+            }
+        }
+        while (active) {
+            for (size_t i = 0; i < active; ++i) {
+                __builtin_prefetch(cur[i]->data);
+            }
+            /* compact the lookups that are still going as we go */
+            size_t next = 0;
+            for (size_t i = 0; i < active; ++i) {
+                int cmp = compare(keys[idx[i]], cur[i]->data, param);
+                if (cmp == 0) {
+                    values[idx[i]] = cur[i]->data;
+                    continue;
+                }
+                const struct node *child = cur[i]->link[cmp > 0];
+                if (!child)
+                    continue;
+                __builtin_prefetch(child);
+                cur[next] = child;
+                idx[next++] = idx[i];
+            }
+            active = next;
+        }
+    }
+}
@@ -0,0 +1,55 @@
+#ifndef LIBAVL_ALLOC_H
+#define LIBAVL_ALLOC_H
+
+/*
+ * The allocators of alloc.h behind libavl's struct libavl_allocator, and
+ * node-level helpers, shared by the avl and rb backends.
+ *
+ * ALLOCATOR_SLAB gives every tree its own slab: nodes of `node_size` bytes
+ * are carved back to back, without headers, from chunks sized for the
+ * table's capacity, so that a freshly loaded tree occupies one contiguous
+ * block in insertion order. Freed nodes are recycled through a free list;
+ * the chunks are only released with the tree. Other allocations (the
+ * table itself) go to malloc.
+ */
+
+#include "alloc.h"
+
+struct libavl_allocator;
+
+/*
+ * The libavl allocator for `allocator`, `fallback` for ALLOCATOR_DEFAULT.
+ * For ALLOCATOR_SLAB a new slab for at least `capacity` nodes of
+ * `node_size` bytes is created, to be released with
+ * libavl_allocator_release() after the tree has been destroyed.
+ */
+struct libavl_allocator *
+libavl_allocator_for(enum allocator allocator,
+                     struct libavl_allocator *fallback, size_t node_size,
+                     size_t capacity);
+/* Release a slab; a no-op for all other allocators */
+void libavl_allocator_release(struct libavl_allocator *allocator);
+
+/*
+ * Copy the `count` nodes of the tree at *root into a single new slab chunk
+ * in `layout` order and release the old chunks. Nodes must start with
+ * their two child links, as struct avl_node and struct rb_node do, and
+ * the tree must not have parent pointers. Traversers over the tree become
+ * invalid. A no-op unless `allocator` is a slab.
+ */
+void libavl_relayout(struct libavl_allocator *allocator, void **root,
+                     size_t count, enum layout layout);
+
+/* avl_comparison_func and rb_comparison_func */
+typedef int libavl_compare_func(const void *a, const void *b, void *param);
+
+/*
+ * Find the items equal to keys[0], ..., keys[n - 1] in the tree at root,
+ * storing them (or NULL) in values, with the lookups interleaved level by
+ * level and the next nodes prefetched.
+ */
+void libavl_find_batch(const void *root, libavl_compare_func *compare,
+                       void *param, void **keys, const void **values,
+                       size_t n);
+
+#endif
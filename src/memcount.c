@@ -0,0 +1,110 @@
+/*
+ * Allocation counting for products without allocator hooks (glib,
+ * hsearch), as a shared library to be preloaded into the driver:
+ *
+ *   LD_PRELOAD=build/libmemcount.so build/bench -o phases=memory glib
+ *
+ * The library replaces the malloc family of the whole process, including
+ * the shared libraries under test, and forwards to glibc's own functions
+ * (see "Replacing malloc" in the glibc manual). The driver finds
+ * memcount_start() and memcount_stop() at run time, see
+ * alloc_interpose_start(). Only the memory phase is run with the library
+ * preloaded, so the timed phases keep glibc's malloc as is.
+ *
+ * Like the counting allocator, the counters are not thread-safe.
+ */
+#include "alloc.h"
+
+#include <errno.h>
+#include <malloc.h>
+
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t n, size_t size);
+extern void *__libc_realloc(void *p, size_t size);
+extern void *__libc_memalign(size_t alignment, size_t size);
+extern void *__libc_valloc(size_t size);
+extern void *__libc_pvalloc(size_t size);
+extern void __libc_free(void *p);
+
+/* the driver's counters while counting, NULL otherwise */
+static struct alloc_stats *stats;
+
+static void account_alloc(void *p)
+{
+    stats->live += malloc_usable_size(p);
+    stats->n_allocs++;
+    if (stats->live > stats->peak)
+        stats->peak = stats->live;
+}
+
+static void account_free(void *p)
+{
+    /* blocks allocated before memcount_start() are not accounted for */
+    size_t size = malloc_usable_size(p);
+    stats->live = stats->live > size ? stats->live - size : 0;
+}
+
+static void *counted(void *p)
+{
+    if (stats && p)
+        account_alloc(p);
+    return p;
+}
+
+void *malloc(size_t size) { return counted(__libc_malloc(size)); }
+
+void *calloc(size_t n, size_t size) { return counted(__libc_calloc(n, size)); }
+
+void *realloc(void *p, size_t size)
+{
+    if (!stats)
+        return __libc_realloc(p, size);
+    size_t old_live = stats->live;
+    if (p)
+        account_free(p);
+    void *q = __libc_realloc(p, size);
+    if (q)
+        account_alloc(q);
+    else if (p)
+        stats->live = old_live;
+    return q;
+}
+
+void free(void *p)
+{
+    if (stats && p)
+        account_free(p);
+    __libc_free(p);
+}
+
+/* the aligned entry points, which bptree takes its nodes from */
+void *memalign(size_t alignment, size_t size)
+{
+    return counted(__libc_memalign(alignment, size));
+}
+
+void *aligned_alloc(size_t alignment, size_t size)
+{
+    return counted(__libc_memalign(alignment, size));
+}
+
+int posix_memalign(void **p, size_t alignment, size_t size)
+{
+    if (alignment % sizeof(void *) != 0 ||
+        (alignment & (alignment - 1)) != 0 || alignment == 0)
+        return EINVAL;
+    void *q = counted(__libc_memalign(alignment, size));
+    if (!q)
+        return ENOMEM;
+    *p = q;
+    return 0;
+}
+
+void *valloc(size_t size) { return counted(__libc_valloc(size)); }
+
+void *pvalloc(size_t size) { return counted(__libc_pvalloc(size)); }
+
+/* Count every allocation into *s until memcount_stop() */
+void memcount_start(struct alloc_stats *s) { stats = s; }
+
+void memcount_stop(void) { stats = NULL; }
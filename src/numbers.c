@@ -2,6 +2,8 @@
 
 #include <stdlib.h>
 
+#include "utils.h"
+
 /*
  * Create an integer sequence k, k+1, ..., k + n.
  */
@@ -20,12 +22,6 @@ int *make_numbers(const size_t n, const size_t k)
  */
 int *shuffle_numbers(int *arr, size_t size)
 {
-    int tmp;
-    for (size_t i = 0; i < size - 1; ++i) {
-        size_t j = drand48() * (i + 1);
-        tmp = arr[i];
-        arr[i] = arr[j];
-        arr[j] = tmp;
-    }
+    shuffle(arr, size, sizeof(int));
     return arr;
 }
@@ -0,0 +1,428 @@
+#define _GNU_SOURCE
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bench.h"
+
+/*
+ * Read scaling: one table, loaded once, is queried concurrently by 1..N
+ * reader threads. Every reader is pinned to its own CPU (round-robin over
+ * the CPUs the process may run on) and looks up its own slice of the
+ * shuffled keys, so that the readers share the work of one pass over the
+ * key set and nothing but the table.
+ *
+ * Per (rep, thread count) we report two rows:
+ *
+ *   parallel_query          wall-clock time / total lookups, i.e. the
+ *                           inverse of the aggregate throughput
+ *   parallel_query_latency  total reader time / total lookups, with the
+ *                           percentiles of the merged per-thread samples
+ *
+ * Hardware counters only cover the calling thread and are not reported.
+ */
+
+struct reader {
+    pthread_t thread;
+    const struct context *ctx;
+    const void *table;
+    void **refs; /* the reader's slice of the query keys */
+    size_t n;
+    int cpu;
+    pthread_barrier_t *barrier;
+    struct TimeInterval ti;
+    struct histogram hist;
+};
+
+static void pin_thread(int cpu)
+{
+    if (cpu >= 0) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    }
+}
+
+static inline void reader_ops(const struct reader *r, struct sampler *s)
+{
+    const struct backend *b = r->ctx->b;
+    for (size_t j = 0; j < r->n; j++) {
+        sampler_begin(s);
+        b->get(r->table, r->refs[j]);
+        sampler_end(s);
+    }
+}
+
+/*
+ * As in the single-threaded phases, latencies are sampled in a pass of
+ * their own; it starts when all readers have finished the timed one.
+ */
+static void *reader_main(void *arg)
+{
+    struct reader *r = (struct reader *)arg;
+    struct sampler sampler;
+
+    pin_thread(r->cpu);
+    sampler_init(&sampler, &r->hist, r->ctx->w->latency_sample);
+
+    pthread_barrier_wait(r->barrier);
+    timer_start(&r->ti);
+    reader_ops(r, NULL);
+    timer_stop(&r->ti);
+    pthread_barrier_wait(r->barrier);
+    if (r->ctx->w->latency_sample)
+        reader_ops(r, &sampler);
+    return NULL;
+}
+
+/* The CPUs this process may run on, in ascending order */
+static size_t allowed_cpus(int *cpus, size_t max)
+{
+    cpu_set_t set;
+    size_t n = 0;
+    if (sched_getaffinity(0, sizeof(set), &set) != 0)
+        return 0;
+    for (int cpu = 0; cpu < CPU_SETSIZE && n < max; ++cpu) {
+        if (CPU_ISSET(cpu, &set))
+            cpus[n++] = cpu;
+    }
+    return n;
+}
+
+void perf_parallel_query(const struct context *ctx, size_t scale)
+{
+    const struct backend *b = ctx->b;
+    const struct workload *w = ctx->w;
+    struct keys *keys = create_keys(ctx, scale, 0);
+    struct keys *query_keys = create_keys(ctx, scale, 0);
+    void *t = load_table(ctx, keys, scale, scale);
+
+    int cpus[CPU_SETSIZE];
+    size_t n_cpus = allowed_cpus(cpus, CPU_SETSIZE);
+
+    for (size_t k = 0; k < w->n_threads; ++k) {
+        size_t n_threads = w->threads[k];
+        struct reader *readers = calloc(n_threads, sizeof(struct reader));
+        pthread_barrier_t barrier;
+        for (size_t i = 0; i < n_threads; ++i) {
+            readers[i].ctx = ctx;
+            readers[i].table = t;
+            readers[i].refs = query_keys->refs + scale * i / n_threads;
+            readers[i].n = scale * (i + 1) / n_threads - scale * i / n_threads;
+            readers[i].cpu = n_cpus ? cpus[i % n_cpus] : -1;
+            readers[i].barrier = &barrier;
+        }
+        if (n_threads > n_cpus)
+            fprintf(stderr, "%s: %lu readers on %lu cpus\n", b->name,
+                    n_threads, n_cpus);
+
+        struct histogram merged;
+        for (size_t rep = 0; rep < w->reps; ++rep) {
+            /* drand48 is not thread-safe, shuffle before starting */
+            keys_shuffle(query_keys);
+            pthread_barrier_init(&barrier, NULL, n_threads);
+            for (size_t i = 0; i < n_threads; ++i) {
+                pthread_create(&readers[i].thread, NULL, reader_main,
+                               &readers[i]);
+            }
+            for (size_t i = 0; i < n_threads; ++i) {
+                pthread_join(readers[i].thread, NULL);
+            }
+            pthread_barrier_destroy(&barrier);
+
+            /* wall clock from the first start to the last stop */
+            /* (the tick counter is synchronised across CPUs) */
+            uint64_t first = readers[0].ti.begin;
+            uint64_t last = readers[0].ti.end;
+            double thread_ns = 0.0;
+            hist_reset(&merged);
+            for (size_t i = 0; i < n_threads; ++i) {
+                if (readers[i].ti.begin < first)
+                    first = readers[i].ti.begin;
+                if (readers[i].ti.end > last)
+                    last = readers[i].ti.end;
+                thread_ns += timer_nsec(&readers[i].ti);
+                hist_merge(&merged, &readers[i].hist);
+            }
+            double wall_ns_per_op =
+                ticks_elapsed(first, last) / ticks_per_nsec() / (double)scale;
+            print_row(ctx, rep, "parallel_query", scale, n_threads,
+                      wall_ns_per_op, NULL, NULL, scale, NULL);
+            print_row(ctx, rep, "parallel_query_latency", scale, n_threads,
+                      thread_ns / (double)scale, &merged, NULL, scale, NULL);
+        }
+        free(readers);
+    }
+    b->destroy(t);
+    keys_delete(query_keys);
+    keys_delete(keys);
+}
+
+/*
+ * Snapshot reads (MVCC): a single writer keeps publishing new versions of
+ * a persistent table through an atomic root pointer, alternating pset and
+ * premove of loaded keys, while 1..N readers each grab the current root
+ * for every lookup. Readers never block the writer and vice versa.
+ *
+ * The writer publishes update_fraction * scale versions; the readers loop
+ * over their shuffled keys until it is done, so both sides are measured
+ * over the same contended window. Per (rep, reader count) we report
+ *
+ *   snapshot_write  writer time per published version and, for backends
+ *                   with allocator hooks, the bytes and allocations each
+ *                   version allocates (nothing is reclaimed, see below)
+ *   snapshot_read   total reader time / total lookups
+ *
+ * The latency percentiles come from a second, untimed run on a fresh
+ * table, see snapshot_run().
+ *
+ * Superseded versions share structure with their successors and cannot be
+ * freed individually without a reclamation scheme, so like the persistent
+ * phases in bench.c we only destroy the initial table. The tables are
+ * timed with the workload's allocator; the bytes come from an untimed
+ * replay of the writer's updates, see snapshot_bytes().
+ */
+
+struct snapshot {
+    _Atomic(const void *) root;
+    atomic_int done;
+    pthread_barrier_t barrier;
+    int sample; /* the untimed run that samples latencies */
+};
+
+struct snapshot_reader {
+    pthread_t thread;
+    const struct context *ctx;
+    struct snapshot *snap;
+    struct keys *keys;
+    int cpu;
+    size_t n_lookups;
+    struct TimeInterval ti;
+    struct histogram hist;
+};
+
+struct snapshot_writer {
+    pthread_t thread;
+    const struct context *ctx;
+    struct snapshot *snap;
+    struct keys *keys;
+    size_t n_updates;
+    int cpu;
+    struct TimeInterval ti;
+    struct histogram hist;
+};
+
+/* Look up keys until the writer is done; returns the number of lookups */
+static inline size_t snapshot_read_ops(const struct snapshot_reader *r,
+                                       struct sampler *s)
+{
+    const struct backend *b = r->ctx->b;
+    struct snapshot *snap = r->snap;
+    size_t j = 0;
+    while (!atomic_load_explicit(&snap->done, memory_order_relaxed)) {
+        sampler_begin(s);
+        const void *t =
+            atomic_load_explicit(&snap->root, memory_order_acquire);
+        b->get(t, r->keys->refs[j % r->keys->n]);
+        sampler_end(s);
+        ++j;
+    }
+    return j;
+}
+
+static void *snapshot_reader_main(void *arg)
+{
+    struct snapshot_reader *r = (struct snapshot_reader *)arg;
+    struct snapshot *snap = r->snap;
+    struct sampler sampler;
+
+    pin_thread(r->cpu);
+    pthread_barrier_wait(&snap->barrier);
+    if (snap->sample) {
+        sampler_init(&sampler, &r->hist, r->ctx->w->latency_sample);
+        snapshot_read_ops(r, &sampler);
+        return NULL;
+    }
+    timer_start(&r->ti);
+    r->n_lookups = snapshot_read_ops(r, NULL);
+    timer_stop(&r->ti);
+    return NULL;
+}
+
+static inline void snapshot_write_ops(const struct snapshot_writer *wr,
+                                      struct sampler *s)
+{
+    const struct backend *b = wr->ctx->b;
+    struct snapshot *snap = wr->snap;
+    const void *t = atomic_load_explicit(&snap->root, memory_order_relaxed);
+    for (size_t j = 0; j < wr->n_updates; ++j) {
+        /* remove a key, then put it back in the next version */
+        void *key = wr->keys->refs[(j / 2) % wr->keys->n];
+        sampler_begin(s);
+        t = j % 2 ? b->pset(t, key, key) : b->premove(t, key);
+        atomic_store_explicit(&snap->root, t, memory_order_release);
+        sampler_end(s);
+    }
+    atomic_store_explicit(&snap->done, 1, memory_order_relaxed);
+}
+
+static void *snapshot_writer_main(void *arg)
+{
+    struct snapshot_writer *wr = (struct snapshot_writer *)arg;
+    struct snapshot *snap = wr->snap;
+    struct sampler sampler;
+
+    pin_thread(wr->cpu);
+    pthread_barrier_wait(&snap->barrier);
+    if (snap->sample) {
+        sampler_init(&sampler, &wr->hist, wr->ctx->w->latency_sample);
+        snapshot_write_ops(wr, &sampler);
+        return NULL;
+    }
+    timer_start(&wr->ti);
+    snapshot_write_ops(wr, NULL);
+    timer_stop(&wr->ti);
+    return NULL;
+}
+
+/* One contended window on a freshly loaded table */
+static void snapshot_run(const struct context *ctx, struct keys *keys,
+                         size_t scale, struct snapshot *snap,
+                         struct snapshot_writer *writer,
+                         struct snapshot_reader *readers, size_t n_readers,
+                         int sample)
+{
+    void *t = load_table(ctx, keys, scale, scale);
+    atomic_init(&snap->root, t);
+    atomic_init(&snap->done, 0);
+    snap->sample = sample;
+    pthread_barrier_init(&snap->barrier, NULL, n_readers + 1);
+    for (size_t i = 0; i < n_readers; ++i) {
+        pthread_create(&readers[i].thread, NULL, snapshot_reader_main,
+                       &readers[i]);
+    }
+    pthread_create(&writer->thread, NULL, snapshot_writer_main, writer);
+    pthread_join(writer->thread, NULL);
+    for (size_t i = 0; i < n_readers; ++i) {
+        pthread_join(readers[i].thread, NULL);
+    }
+    pthread_barrier_destroy(&snap->barrier);
+    ctx->b->destroy(t);
+}
+
+/*
+ * Bytes allocated per published version: replay the writer's updates on a
+ * table created through the counting allocator, without readers and
+ * outside the timer, like persistent_bytes() in bench.c. Returns 0 and
+ * leaves mem alone for products without allocator hooks or when the
+ * workload selects another allocator.
+ */
+static int snapshot_bytes(const struct context *ctx, struct keys *keys,
+                          size_t scale, const struct snapshot_writer *writer,
+                          struct alloc_stats *mem)
+{
+    const struct backend *b = ctx->b;
+    if (ctx->allocator != ALLOCATOR_DEFAULT ||
+        !(b->allocators & ALLOCATOR_COUNTING))
+        return 0;
+    struct context mem_ctx = *ctx;
+    mem_ctx.allocator = ALLOCATOR_COUNTING;
+    void *t = load_table(&mem_ctx, keys, scale, scale);
+
+    struct snapshot snap;
+    atomic_init(&snap.root, t);
+    atomic_init(&snap.done, 0);
+    struct snapshot_writer replay = *writer;
+    replay.snap = &snap;
+    struct alloc_stats before = alloc_stats;
+    alloc_stats.peak = alloc_stats.live;
+    snapshot_write_ops(&replay, NULL);
+    mem->live = alloc_stats.live - before.live;
+    mem->peak = alloc_stats.peak - before.live;
+    mem->n_allocs = alloc_stats.n_allocs - before.n_allocs;
+    b->destroy(t);
+    return 1;
+}
+
+void perf_snapshot(const struct context *ctx, size_t scale)
+{
+    const struct backend *b = ctx->b;
+    const struct workload *w = ctx->w;
+    size_t n_updates = w->update_fraction * scale;
+    struct keys *keys = create_keys(ctx, scale, 0);
+
+    if (n_updates == 0)
+        n_updates = 1;
+
+    int cpus[CPU_SETSIZE];
+    size_t n_cpus = allowed_cpus(cpus, CPU_SETSIZE);
+
+    struct snapshot snap;
+    struct snapshot_writer writer = {.ctx = ctx, .snap = &snap,
+                                     .n_updates = n_updates};
+    writer.keys = create_keys(ctx, scale, 0);
+    writer.cpu = n_cpus ? cpus[0] : -1;
+
+    for (size_t k = 0; k < w->n_threads; ++k) {
+        size_t n_readers = w->threads[k];
+        struct snapshot_reader *readers =
+            calloc(n_readers, sizeof(struct snapshot_reader));
+        for (size_t i = 0; i < n_readers; ++i) {
+            readers[i].ctx = ctx;
+            readers[i].snap = &snap;
+            readers[i].keys = create_keys(ctx, scale, 0);
+            /* the writer gets the first CPU to itself if possible */
+            readers[i].cpu = n_cpus ? cpus[(i + 1) % n_cpus] : -1;
+        }
+        if (n_readers + 1 > n_cpus)
+            fprintf(stderr, "%s: writer and %lu readers on %lu cpus\n",
+                    b->name, n_readers, n_cpus);
+
+        struct histogram merged;
+        for (size_t rep = 0; rep < w->reps; ++rep) {
+            keys_shuffle(writer.keys);
+            for (size_t i = 0; i < n_readers; ++i) {
+                keys_shuffle(readers[i].keys);
+            }
+            /* timed, then again untimed with the samplers */
+            snapshot_run(ctx, keys, scale, &snap, &writer, readers,
+                         n_readers, 0);
+            for (size_t i = 0; i < n_readers; ++i) {
+                hist_reset(&readers[i].hist);
+            }
+            hist_reset(&writer.hist);
+            if (w->latency_sample)
+                snapshot_run(ctx, keys, scale, &snap, &writer, readers,
+                             n_readers, 1);
+            struct alloc_stats mem;
+            int counted = snapshot_bytes(ctx, keys, scale, &writer, &mem);
+
+            double read_ns = 0.0;
+            size_t n_lookups = 0;
+            hist_reset(&merged);
+            for (size_t i = 0; i < n_readers; ++i) {
+                read_ns += timer_nsec(&readers[i].ti);
+                n_lookups += readers[i].n_lookups;
+                hist_merge(&merged, &readers[i].hist);
+            }
+            print_row(ctx, rep, "snapshot_write", scale, n_readers,
+                      timer_nsec(&writer.ti) / (double)n_updates,
+                      &writer.hist, NULL, n_updates, counted ? &mem : NULL);
+            /* on few CPUs the writer may finish before a reader ran */
+            if (n_lookups > 0)
+                print_row(ctx, rep, "snapshot_read", scale, n_readers,
+                          read_ns / n_lookups, &merged, NULL, n_lookups,
+                          NULL);
+        }
+        for (size_t i = 0; i < n_readers; ++i) {
+            keys_delete(readers[i].keys);
+        }
+        free(readers);
+    }
+    keys_delete(writer.keys);
+    keys_delete(keys);
+}
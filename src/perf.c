@@ -0,0 +1,113 @@
+#include "perf.h"
+
+#include <string.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+const char *perf_counter_names[N_PERF_COUNTERS] = {
+    "cycles",     "instructions", "l1d_misses",
+    "llc_misses", "dtlb_misses",  "branch_misses"};
+
+#ifdef __linux__
+
+#define HW_CACHE_READ_MISS(cache)                                              \
+    ((cache) | (PERF_COUNT_HW_CACHE_OP_READ << 8) |                            \
+     (PERF_COUNT_HW_CACHE_RESULT_MISS << 16))
+
+static const struct {
+    uint32_t type;
+    uint64_t config;
+} events[N_PERF_COUNTERS] = {
+    [PERF_CYCLES] = {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+    [PERF_INSTRUCTIONS] = {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+    [PERF_L1D_MISSES] = {PERF_TYPE_HW_CACHE,
+                         HW_CACHE_READ_MISS(PERF_COUNT_HW_CACHE_L1D)},
+    [PERF_LLC_MISSES] = {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+    [PERF_DTLB_MISSES] = {PERF_TYPE_HW_CACHE,
+                          HW_CACHE_READ_MISS(PERF_COUNT_HW_CACHE_DTLB)},
+    [PERF_BRANCH_MISSES] = {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+};
+
+int perf_counters_open(struct perf_counters *pc)
+{
+    int n_open = 0;
+    for (int i = 0; i < N_PERF_COUNTERS; ++i) {
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = events[i].type;
+        attr.config = events[i].config;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format =
+            PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        pc->fd[i] = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+        pc->value[i] = 0.0;
+        if (pc->fd[i] >= 0)
+            ++n_open;
+    }
+    return n_open;
+}
+
+void perf_counters_start(struct perf_counters *pc)
+{
+    for (int i = 0; i < N_PERF_COUNTERS; ++i) {
+        if (pc->fd[i] >= 0)
+            ioctl(pc->fd[i], PERF_EVENT_IOC_RESET, 0);
+    }
+    for (int i = 0; i < N_PERF_COUNTERS; ++i) {
+        if (pc->fd[i] >= 0)
+            ioctl(pc->fd[i], PERF_EVENT_IOC_ENABLE, 0);
+    }
+}
+
+void perf_counters_stop(struct perf_counters *pc)
+{
+    for (int i = 0; i < N_PERF_COUNTERS; ++i) {
+        if (pc->fd[i] >= 0)
+            ioctl(pc->fd[i], PERF_EVENT_IOC_DISABLE, 0);
+    }
+    for (int i = 0; i < N_PERF_COUNTERS; ++i) {
+        /* value, time_enabled, time_running */
+        uint64_t buf[3];
+        if (pc->fd[i] < 0)
+            continue;
+        if (read(pc->fd[i], buf, sizeof(buf)) != sizeof(buf) || !buf[2]) {
+            pc->value[i] = 0.0;
+            continue;
+        }
+        pc->value[i] = buf[0] * ((double)buf[1] / buf[2]);
+    }
+}
+
+void perf_counters_close(struct perf_counters *pc)
+{
+    for (int i = 0; i < N_PERF_COUNTERS; ++i) {
+        if (pc->fd[i] >= 0)
+            close(pc->fd[i]);
+        pc->fd[i] = -1;
+    }
+}
+
+#else
+
+int perf_counters_open(struct perf_counters *pc)
+{
+    for (int i = 0; i < N_PERF_COUNTERS; ++i) {
+        pc->fd[i] = -1;
+        pc->value[i] = 0.0;
+    }
+    return 0;
+}
+
+void perf_counters_start(struct perf_counters *pc) {}
+void perf_counters_stop(struct perf_counters *pc) {}
+void perf_counters_close(struct perf_counters *pc) {}
+
+#endif
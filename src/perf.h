@@ -0,0 +1,42 @@
+#ifndef HAMT_BENCH_PERF
+#define HAMT_BENCH_PERF
+
+/*
+ * Hardware performance counters via perf_event_open(2).
+ *
+ * Counters are opened once per run and measure user space only. Each
+ * counter is scheduled independently, so if the PMU has fewer counters
+ * than requested events the kernel multiplexes them and the values are
+ * scaled by time_enabled / time_running. Counters that cannot be opened
+ * (no PMU in a VM, perf_event_paranoid, non-Linux systems) are reported
+ * as unavailable.
+ */
+
+#include <stdint.h>
+
+enum perf_counter {
+    PERF_CYCLES,
+    PERF_INSTRUCTIONS,
+    PERF_L1D_MISSES,
+    PERF_LLC_MISSES,
+    PERF_DTLB_MISSES,
+    PERF_BRANCH_MISSES,
+    N_PERF_COUNTERS
+};
+
+extern const char *perf_counter_names[N_PERF_COUNTERS];
+
+struct perf_counters {
+    int fd[N_PERF_COUNTERS]; /* -1 if the counter is unavailable */
+    double value[N_PERF_COUNTERS];
+};
+
+/* Open all counters; returns the number of available counters */
+int perf_counters_open(struct perf_counters *pc);
+/* Reset and enable all available counters */
+void perf_counters_start(struct perf_counters *pc);
+/* Disable all available counters and read their (scaled) values */
+void perf_counters_stop(struct perf_counters *pc);
+void perf_counters_close(struct perf_counters *pc);
+
+#endif
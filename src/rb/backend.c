@@ -0,0 +1,151 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "../backend.h"
+#include "../libavl_alloc.h"
+#include "rb.h"
+#include "rb_persistent.h"
+
+static int cmp_eq_int(const void *lhs, const void *rhs, void *rb_param)
+{
+    /* expects lhs and rhs to be pointers to ints */
+    const int *l = (const int *)lhs;
+    const int *r = (const int *)rhs;
+
+    if (*l > *r)
+        return 1;
+    return *l == *r ? 0 : -1;
+}
+
+static int cmp_eq_str(const void *lhs, const void *rhs, void *rb_param)
+{
+    return strcmp((const char *)lhs, (const char *)rhs);
+}
+
+static void *rb_backend_create(enum key_type type, size_t capacity,
+                               enum allocator allocator)
+{
+    struct libavl_allocator *ator =
+        libavl_allocator_for(allocator, &rb_allocator_default,
+                             sizeof(struct rb_node), capacity);
+    return rb_create(type == KEY_STR ? cmp_eq_str : cmp_eq_int, NULL, ator);
+}
+
+static void rb_backend_destroy(void *table)
+{
+    struct libavl_allocator *ator = ((struct rb_table *)table)->rb_alloc;
+    rb_destroy(table, NULL);
+    libavl_allocator_release(ator);
+}
+
+/* rb trees store items, not key/value pairs: the key is the item */
+static void rb_backend_set(void *table, void *key, void *value)
+{
+    rb_insert(table, key);
+}
+
+static const void *rb_backend_get(const void *table, void *key)
+{
+    return rb_find(table, key);
+}
+
+static void rb_backend_get_batch(const void *table, void **keys,
+                                const void **values, size_t n)
+{
+    const struct rb_table *t = table;
+    libavl_find_batch(t->rb_root, t->rb_compare, t->rb_param, keys, values,
+                      n);
+}
+
+static void rb_backend_remove(void *table, void *key)
+{
+    rb_delete(table, key);
+}
+
+static const void *rb_backend_pset(const void *table, void *key, void *value)
+{
+    return rb_pinsert(table, key);
+}
+
+static const void *rb_backend_premove(const void *table, void *key)
+{
+    return rb_pdelete(table, key);
+}
+
+static size_t rb_backend_iterate(const void *table)
+{
+    struct rb_traverser trav;
+    size_t n = 0;
+    /* libavl traversers take a non-const table but do not modify it */
+    for (void *item = rb_t_first(&trav, (struct rb_table *)table); item;
+         item = rb_t_next(&trav)) {
+        n++;
+    }
+    return n;
+}
+
+/*
+ * Position trav at the first item not less than item, like rb_t_find but
+ * for keys that are not in the table. The traverser's stack holds the
+ * ancestors of the current node, i.e. the search path up to the match.
+ */
+static void *rb_t_lower_bound(struct rb_traverser *trav,
+                              struct rb_table *tree, void *item)
+{
+    struct rb_node *match = NULL;
+    size_t match_height = 0;
+    trav->rb_table = tree;
+    trav->rb_height = 0;
+    trav->rb_generation = tree->rb_generation;
+    for (struct rb_node *p = tree->rb_root; p != NULL;) {
+        int cmp = tree->rb_compare(item, p->rb_data, tree->rb_param);
+        if (cmp <= 0) {
+            match = p;
+            match_height = trav->rb_height;
+            if (cmp == 0)
+                break;
+        }
+        trav->rb_stack[trav->rb_height++] = p;
+        p = p->rb_link[cmp > 0];
+    }
+    trav->rb_height = match_height;
+    trav->rb_node = match;
+    return match ? match->rb_data : NULL;
+}
+
+static size_t rb_backend_range(const void *table, void *from,
+                               const void **values, size_t n)
+{
+    struct rb_traverser trav;
+    size_t i = 0;
+    /* libavl traversers take a non-const table but do not modify it */
+    void *item = rb_t_lower_bound(&trav, (struct rb_table *)table, from);
+    for (; item && i < n; item = rb_t_next(&trav)) {
+        values[i++] = item;
+    }
+    return i;
+}
+
+static void rb_backend_relayout(void *table, enum layout layout)
+{
+    struct rb_table *t = table;
+    libavl_relayout(t->rb_alloc, (void **)&t->rb_root, t->rb_count, layout);
+}
+
+const struct backend backend_rb = {
+    .name = "rb",
+    .key_types = KEY_INT | KEY_STR,
+    .allocators = ALLOCATOR_DEFAULT | ALLOCATOR_COUNTING | ALLOCATOR_GC |
+                  ALLOCATOR_POOL | ALLOCATOR_SLAB,
+    .create = rb_backend_create,
+    .destroy = rb_backend_destroy,
+    .set = rb_backend_set,
+    .get = rb_backend_get,
+    .get_batch = rb_backend_get_batch,
+    .remove = rb_backend_remove,
+    .pset = rb_backend_pset,
+    .premove = rb_backend_premove,
+    .iterate = rb_backend_iterate,
+    .range = rb_backend_range,
+    .relayout = rb_backend_relayout,
+};
@@ -0,0 +1,272 @@
+#include "rb_persistent.h"
+
+#include <assert.h>
+#include <stddef.h>
+
+/*
+ * The algorithms are those of rb_probe and rb_delete in rb.c, with every
+ * node copied before it is modified. Nodes on the stack |pa| are copies
+ * that belong to the new version; the pseudo-node at pa[0] is the new
+ * table's root pointer, as in rb.c.
+ */
+
+static struct rb_table *new_version(const struct rb_table *tree)
+{
+    struct rb_table *t =
+        tree->rb_alloc->libavl_malloc(tree->rb_alloc, sizeof *t);
+    if (t != NULL) {
+        *t = *tree;
+        t->rb_generation = 0;
+    }
+    return t;
+}
+
+static struct rb_node *copy_node(struct rb_table *t, const struct rb_node *p)
+{
+    struct rb_node *q = t->rb_alloc->libavl_malloc(t->rb_alloc, sizeof *q);
+    if (q != NULL)
+        *q = *p;
+    return q;
+}
+
+/* Replace the child |dir| of |parent| by a copy; returns the copy */
+static struct rb_node *copy_child(struct rb_table *t, struct rb_node *parent,
+                                  int dir)
+{
+    return parent->rb_link[dir] = copy_node(t, parent->rb_link[dir]);
+}
+
+const struct rb_table *rb_pinsert(const struct rb_table *tree, void *item)
+{
+    struct rb_node *pa[RB_MAX_HEIGHT]; /* Copied nodes on stack. */
+    unsigned char da[RB_MAX_HEIGHT];   /* Directions moved from stack nodes. */
+    int k;                             /* Stack height. */
+    struct rb_node *p, *n;
+
+    assert(tree != NULL && item != NULL);
+    struct rb_table *t = new_version(tree);
+    if (t == NULL)
+        return NULL;
+
+    pa[0] = (struct rb_node *)&t->rb_root;
+    da[0] = 0;
+    k = 1;
+    for (p = t->rb_root; p != NULL; p = p->rb_link[da[k - 1]]) {
+        int cmp = t->rb_compare(item, p->rb_data, t->rb_param);
+        p = copy_child(t, pa[k - 1], da[k - 1]);
+        if (p == NULL)
+            return NULL;
+        if (cmp == 0) {
+            p->rb_data = item;
+            return t;
+        }
+
+        pa[k] = p;
+        da[k++] = cmp > 0;
+    }
+
+    n = pa[k - 1]->rb_link[da[k - 1]] =
+        t->rb_alloc->libavl_malloc(t->rb_alloc, sizeof *n);
+    if (n == NULL)
+        return NULL;
+
+    n->rb_data = item;
+    n->rb_link[0] = n->rb_link[1] = NULL;
+    n->rb_color = RB_RED;
+    t->rb_count++;
+
+    while (k >= 3 && pa[k - 1]->rb_color == RB_RED) {
+        int dir = da[k - 2]; /* side of the parent, the uncle is opposite */
+        struct rb_node *y = pa[k - 2]->rb_link[!dir];
+        if (y != NULL && y->rb_color == RB_RED) {
+            /* the uncle is recoloured: copy it */
+            y = copy_child(t, pa[k - 2], !dir);
+            if (y == NULL)
+                return NULL;
+            pa[k - 1]->rb_color = y->rb_color = RB_BLACK;
+            pa[k - 2]->rb_color = RB_RED;
+            k -= 2;
+        } else {
+            struct rb_node *x;
+
+            if (da[k - 1] == dir)
+                y = pa[k - 1];
+            else {
+                x = pa[k - 1];
+                y = x->rb_link[!dir];
+                x->rb_link[!dir] = y->rb_link[dir];
+                y->rb_link[dir] = x;
+                pa[k - 2]->rb_link[dir] = y;
+            }
+
+            x = pa[k - 2];
+            x->rb_color = RB_RED;
+            y->rb_color = RB_BLACK;
+
+            x->rb_link[dir] = y->rb_link[!dir];
+            y->rb_link[!dir] = x;
+            pa[k - 3]->rb_link[da[k - 3]] = y;
+            break;
+        }
+    }
+    t->rb_root->rb_color = RB_BLACK;
+
+    return t;
+}
+
+const struct rb_table *rb_pdelete(const struct rb_table *tree,
+                                  const void *item)
+{
+    struct rb_node *pa[RB_MAX_HEIGHT]; /* Copied nodes on stack. */
+    unsigned char da[RB_MAX_HEIGHT];   /* Directions moved from stack nodes. */
+    int k;                             /* Stack height. */
+    struct rb_node *p; /* The node to delete, or a node part way to it. */
+    struct rb_node deleted;
+    int cmp;
+
+    assert(tree != NULL && item != NULL);
+    /* look before copying anything */
+    if (rb_find(tree, item) == NULL)
+        return tree;
+    struct rb_table *t = new_version(tree);
+    if (t == NULL)
+        return NULL;
+
+    k = 0;
+    p = (struct rb_node *)&t->rb_root;
+    for (cmp = -1; cmp != 0;) {
+        int dir = cmp > 0;
+
+        pa[k] = p;
+        da[k++] = dir;
+
+        p = p->rb_link[dir];
+        cmp = t->rb_compare(item, p->rb_data, t->rb_param);
+        /* the deleted node itself stays with the old version */
+        if (cmp != 0 && (p = copy_child(t, pa[k - 1], dir)) == NULL)
+            return NULL;
+    }
+    deleted = *p;
+    p = &deleted;
+
+    if (p->rb_link[1] == NULL)
+        pa[k - 1]->rb_link[da[k - 1]] = p->rb_link[0];
+    else {
+        enum rb_color c;
+        struct rb_node *r = copy_child(t, p, 1);
+        if (r == NULL)
+            return NULL;
+
+        if (r->rb_link[0] == NULL) {
+            r->rb_link[0] = p->rb_link[0];
+            c = r->rb_color;
+            r->rb_color = p->rb_color;
+            p->rb_color = c;
+            pa[k - 1]->rb_link[da[k - 1]] = r;
+            da[k] = 1;
+            pa[k++] = r;
+        } else {
+            struct rb_node *s;
+            int j = k++;
+
+            for (;;) {
+                da[k] = 0;
+                pa[k++] = r;
+                s = copy_child(t, r, 0);
+                if (s == NULL)
+                    return NULL;
+                if (s->rb_link[0] == NULL)
+                    break;
+
+                r = s;
+            }
+
+            da[j] = 1;
+            pa[j] = s;
+            pa[j - 1]->rb_link[da[j - 1]] = s;
+
+            s->rb_link[0] = p->rb_link[0];
+            r->rb_link[0] = s->rb_link[1];
+            s->rb_link[1] = p->rb_link[1];
+
+            c = s->rb_color;
+            s->rb_color = p->rb_color;
+            p->rb_color = c;
+        }
+    }
+
+    if (p->rb_color == RB_BLACK) {
+        /* x is the old version's node at first, a copy further up */
+        for (int copied = 0;; copied = 1) {
+            struct rb_node *x = pa[k - 1]->rb_link[da[k - 1]];
+            if (x != NULL && x->rb_color == RB_RED) {
+                if (!copied)
+                    x = copy_child(t, pa[k - 1], da[k - 1]);
+                if (x == NULL)
+                    return NULL;
+                x->rb_color = RB_BLACK;
+                break;
+            }
+            if (k < 2)
+                break;
+
+            int dir = da[k - 1]; /* side of x, the sibling is opposite */
+            struct rb_node *w = copy_child(t, pa[k - 1], !dir);
+            if (w == NULL)
+                return NULL;
+
+            if (w->rb_color == RB_RED) {
+                w->rb_color = RB_BLACK;
+                pa[k - 1]->rb_color = RB_RED;
+
+                pa[k - 1]->rb_link[!dir] = w->rb_link[dir];
+                w->rb_link[dir] = pa[k - 1];
+                pa[k - 2]->rb_link[da[k - 2]] = w;
+
+                pa[k] = pa[k - 1];
+                da[k] = dir;
+                pa[k - 1] = w;
+                k++;
+
+                w = copy_child(t, pa[k - 1], !dir);
+                if (w == NULL)
+                    return NULL;
+            }
+
+            if ((w->rb_link[0] == NULL ||
+                 w->rb_link[0]->rb_color == RB_BLACK) &&
+                (w->rb_link[1] == NULL || w->rb_link[1]->rb_color == RB_BLACK))
+                w->rb_color = RB_RED;
+            else {
+                struct rb_node *z; /* w's child away from x */
+                if (w->rb_link[!dir] == NULL ||
+                    w->rb_link[!dir]->rb_color == RB_BLACK) {
+                    struct rb_node *y = copy_child(t, w, dir);
+                    if (y == NULL)
+                        return NULL;
+                    y->rb_color = RB_BLACK;
+                    w->rb_color = RB_RED;
+                    w->rb_link[dir] = y->rb_link[!dir];
+                    y->rb_link[!dir] = w;
+                    z = w;
+                    w = pa[k - 1]->rb_link[!dir] = y;
+                } else if ((z = copy_child(t, w, !dir)) == NULL)
+                    return NULL;
+
+                w->rb_color = pa[k - 1]->rb_color;
+                pa[k - 1]->rb_color = RB_BLACK;
+                z->rb_color = RB_BLACK;
+
+                pa[k - 1]->rb_link[!dir] = w->rb_link[dir];
+                w->rb_link[dir] = pa[k - 1];
+                pa[k - 2]->rb_link[da[k - 2]] = w;
+                break;
+            }
+
+            k--;
+        }
+    }
+
+    t->rb_count--;
+    return t;
+}
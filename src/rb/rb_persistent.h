@@ -0,0 +1,33 @@
+#ifndef RB_PERSISTENT_H
+#define RB_PERSISTENT_H
+
+/*
+ * Persistent updates of libavl red-black tables by path copying.
+ *
+ * rb_pinsert and rb_pdelete leave `tree` untouched and return a new table
+ * that shares every node off the updated path with it. The path from the
+ * root to the insertion or deletion point is copied, and so is every node
+ * next to it that the rebalancing of rb_probe and rb_delete recolours or
+ * rotates (the uncle on insertion, the sibling and its children on
+ * deletion), so an update allocates O(log n) nodes plus the table header.
+ *
+ * Old versions stay valid until the nodes they share are freed; nothing
+ * tracks the sharing, so versions are leaked unless the table's allocator
+ * collects them.
+ */
+
+#include "rb.h"
+
+/*
+ * Insert |item|, replacing a duplicate. Returns the new version, or NULL
+ * if memory allocation failed (the nodes copied so far are leaked).
+ */
+const struct rb_table *rb_pinsert(const struct rb_table *tree, void *item);
+/*
+ * Delete the item matching |item|. Returns the new version, |tree| itself
+ * if there is no such item, or NULL if memory allocation failed.
+ */
+const struct rb_table *rb_pdelete(const struct rb_table *tree,
+                                  const void *item);
+
+#endif
@@ -1,5 +1,6 @@
 #include "stats.h"
 
+#include <math.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -27,3 +28,188 @@ double trimmed_mean(double *arr, size_t arrsize, double p)
     free(copy);
     return sum / (upper_ix - lower_ix);
 }
+
+double sample_mean(const double *x, size_t n)
+{
+    double sum = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+        sum += x[i];
+    }
+    return n ? sum / n : 0.0;
+}
+
+double sample_stddev(const double *x, size_t n)
+{
+    if (n < 2)
+        return 0.0;
+    double mu = sample_mean(x, n);
+    double ss = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+        ss += (x[i] - mu) * (x[i] - mu);
+    }
+    return sqrt(ss / (n - 1));
+}
+
+/* median of an array that may be reordered */
+static double median_inplace(double *x, size_t n)
+{
+    if (n == 0)
+        return 0.0;
+    qsort(x, n, sizeof(double), cmp_double);
+    return n % 2 ? x[n / 2] : (x[n / 2 - 1] + x[n / 2]) / 2.0;
+}
+
+double median(const double *x, size_t n)
+{
+    double *copy = malloc(n * sizeof(double));
+    memcpy(copy, x, n * sizeof(double));
+    double m = median_inplace(copy, n);
+    free(copy);
+    return m;
+}
+
+double mad(const double *x, size_t n)
+{
+    double med = median(x, n);
+    double *dev = malloc(n * sizeof(double));
+    for (size_t i = 0; i < n; ++i) {
+        dev[i] = fabs(x[i] - med);
+    }
+    double m = median_inplace(dev, n);
+    free(dev);
+    return m;
+}
+
+size_t warmup_length(const double *x, size_t n)
+{
+    /* suffix sums, so that every cut is evaluated in O(1) */
+    double s1 = 0.0, s2 = 0.0;
+    double best = INFINITY;
+    size_t best_d = 0;
+    for (size_t d = n; d-- > 0;) {
+        s1 += x[d];
+        s2 += x[d] * x[d];
+        if (d > n / 2)
+            continue;
+        double m = n - d;
+        double mser = (s2 - s1 * s1 / m) / (m * m);
+        /* ties go to the shorter warmup */
+        if (mser <= best) {
+            best = mser;
+            best_d = d;
+        }
+    }
+    return best_d;
+}
+
+size_t flag_outliers(const double *x, size_t n, unsigned char *flags)
+{
+    double med = median(x, n);
+    double scale = 1.4826 * mad(x, n);
+    size_t count = 0;
+    for (size_t i = 0; i < n; ++i) {
+        flags[i] = scale > 0.0 && fabs(x[i] - med) / scale > OUTLIER_Z;
+        count += flags[i];
+    }
+    return count;
+}
+
+/* splitmix64 */
+static uint64_t next_random(uint64_t *state)
+{
+    uint64_t z = (*state += 0x9e3779b97f4a7c15ull);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
+
+void bootstrap_ci(const double *x, size_t n, estimator *estimate,
+                  double level, size_t resamples, uint64_t seed, double *lo,
+                  double *hi)
+{
+    if (n == 0 || resamples == 0) {
+        *lo = *hi = n ? estimate(x, n) : 0.0;
+        return;
+    }
+    double *sample = malloc(n * sizeof(double));
+    double *estimates = malloc(resamples * sizeof(double));
+    uint64_t state = seed;
+    for (size_t b = 0; b < resamples; ++b) {
+        for (size_t i = 0; i < n; ++i) {
+            sample[i] = x[next_random(&state) % n];
+        }
+        estimates[b] = estimate(sample, n);
+    }
+    qsort(estimates, resamples, sizeof(double), cmp_double);
+    size_t i_lo = (size_t)floor((1.0 - level) / 2.0 * resamples);
+    size_t i_hi = (size_t)ceil((1.0 + level) / 2.0 * resamples);
+    *lo = estimates[i_lo];
+    *hi = estimates[i_hi > 0 ? i_hi - 1 : 0];
+    free(estimates);
+    free(sample);
+}
+
+void summarize(const double *x, size_t n, struct summary *s)
+{
+    s->warmup = warmup_length(x, n);
+    x += s->warmup;
+    n -= s->warmup;
+    s->n = n;
+    s->mean = sample_mean(x, n);
+    s->stddev = sample_stddev(x, n);
+    s->median = median(x, n);
+    s->mad = mad(x, n);
+    unsigned char *flags = malloc(n ? n : 1);
+    s->outliers = flag_outliers(x, n, flags);
+    free(flags);
+    bootstrap_ci(x, n, median, 0.95, BOOTSTRAP_RESAMPLES, 1, &s->ci_lo,
+                 &s->ci_hi);
+}
+
+struct ranked {
+    double value;
+    int in_y;
+};
+
+static int cmp_ranked(const void *lhs, const void *rhs)
+{
+    return cmp_double(&((const struct ranked *)lhs)->value,
+                      &((const struct ranked *)rhs)->value);
+}
+
+double mann_whitney(const double *x, size_t nx, const double *y, size_t ny,
+                    double *delta)
+{
+    *delta = 0.0;
+    if (nx == 0 || ny == 0)
+        return 1.0;
+    size_t n = nx + ny;
+    struct ranked *r = malloc(n * sizeof(struct ranked));
+    for (size_t i = 0; i < nx; ++i) {
+        r[i] = (struct ranked){x[i], 0};
+    }
+    for (size_t i = 0; i < ny; ++i) {
+        r[nx + i] = (struct ranked){y[i], 1};
+    }
+    qsort(r, n, sizeof(struct ranked), cmp_ranked);
+    /* rank sum of y with ties at their mean rank, and the tie correction */
+    double rank_sum = 0.0, ties = 0.0;
+    for (size_t i = 0, j; i < n; i = j) {
+        size_t in_y = 0;
+        for (j = i; j < n && r[j].value == r[i].value; ++j) {
+            in_y += r[j].in_y;
+        }
+        double t = j - i;
+        rank_sum += in_y * (i + 1 + j) / 2.0;
+        ties += t * t * t - t;
+    }
+    free(r);
+    double u = rank_sum - ny * (ny + 1) / 2.0;
+    double pairs = (double)nx * ny;
+    *delta = 2.0 * u / pairs - 1.0;
+    double var = pairs / 12.0 * (n + 1 - ties / ((double)n * (n - 1)));
+    if (var <= 0.0)
+        return 1.0;
+    double z = (fabs(u - pairs / 2.0) - 0.5) / sqrt(var);
+    return z > 0.0 ? erfc(z / sqrt(2.0)) : 1.0;
+}
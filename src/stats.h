@@ -1,9 +1,86 @@
 #ifndef STATS_C
 #define STATS_C
 
+/*
+ * Descriptive statistics over the repetitions of a measurement.
+ *
+ * The robust estimators (median, MAD) are the ones to compare runs with:
+ * benchmark times are skewed and a single preempted repetition moves the
+ * mean. The warmup and outlier definitions are shared with the
+ * numbers_flagged and robust_stats views in db/migrations/009-analysis.sql:
+ *
+ *   warmup    leading repetitions dropped by MSER: the cut d <= n/2 that
+ *             minimises the squared standard error of the mean of the
+ *             remaining n - d values, sum((x - mean)^2) / (n - d)^2
+ *   outlier   a value whose modified z-score |x - median| / (1.4826 MAD)
+ *             exceeds OUTLIER_Z (Iglewicz and Hoaglin)
+ *   ci        percentile bootstrap confidence interval of the median
+ *
+ * The confidence intervals differ: SQL cannot resample, so robust_stats
+ * takes the distribution-free order-statistic interval of the median
+ * instead.
+ *
+ * Two sets of repetitions, e.g. of two libhamt commits, are compared with
+ * the Mann-Whitney U test, which makes no assumption about the shape of
+ * the distributions.
+ */
+
 #include <stddef.h>
+#include <stdint.h>
+
+#define OUTLIER_Z 3.5
+#define BOOTSTRAP_RESAMPLES 1000
 
 int cmp_double(const void *lhs, const void *rhs);
 double trimmed_mean(double *arr, size_t arrsize, double p);
 
+double sample_mean(const double *x, size_t n);
+/* with Bessel's correction, 0 for n < 2 */
+double sample_stddev(const double *x, size_t n);
+double median(const double *x, size_t n);
+/* median absolute deviation from the median, unscaled */
+double mad(const double *x, size_t n);
+
+/* Number of leading warmup values to drop, see above */
+size_t warmup_length(const double *x, size_t n);
+/* Set flags[i] if x[i] is an outlier; returns the number of outliers */
+size_t flag_outliers(const double *x, size_t n, unsigned char *flags);
+
+typedef double estimator(const double *x, size_t n);
+
+/*
+ * Percentile bootstrap: the central `level` (e.g. 0.95) interval of
+ * `estimate` over `resamples` resamples of x with replacement. The
+ * resamples are drawn from a generator seeded with `seed`, so the result
+ * is reproducible and the driver's drand48 stream is left alone.
+ */
+void bootstrap_ci(const double *x, size_t n, estimator *estimate,
+                  double level, size_t resamples, uint64_t seed, double *lo,
+                  double *hi);
+
+struct summary {
+    size_t n;        /* values after the warmup */
+    size_t warmup;   /* leading values dropped */
+    size_t outliers; /* outliers among the n values */
+    double mean;
+    double stddev;
+    double median;
+    double mad;
+    double ci_lo; /* 95% bootstrap confidence interval of the median */
+    double ci_hi;
+};
+
+/* Drop the warmup of x and summarise the rest */
+void summarize(const double *x, size_t n, struct summary *s);
+
+/*
+ * Two-sided Mann-Whitney U test of x against y. Returns the p-value of the
+ * normal approximation with tie and continuity corrections (good from
+ * about eight values per side) and sets *delta to Cliff's delta, the
+ * probability that a value of y exceeds one of x minus the reverse: 1 if
+ * every y is larger, -1 if every y is smaller.
+ */
+double mann_whitney(const double *x, size_t nx, const double *y, size_t ny,
+                    double *delta);
+
 #endif /* STATS_C */
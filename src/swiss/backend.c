@@ -0,0 +1,107 @@
+#include <string.h>
+
+#include "../backend.h"
+#include "../hash.h"
+#include "swiss.h"
+
+/* keys are hashed with the workload's hash function, like libhamt's */
+static uint32_t hash_int(const void *key)
+{
+    return key_hash(key, sizeof(int), 0);
+}
+
+static int eq_int(const void *lhs, const void *rhs)
+{
+    return *(const int *)lhs == *(const int *)rhs;
+}
+
+static uint32_t hash_string(const void *key)
+{
+    return key_hash(key, strlen((const char *)key), 0);
+}
+
+static int eq_string(const void *lhs, const void *rhs)
+{
+    return strcmp((const char *)lhs, (const char *)rhs) == 0;
+}
+
+static struct swiss_allocator swiss_allocator_counting = {counting_malloc,
+                                                          counting_free};
+
+static struct swiss_allocator swiss_allocator_pool = {pool_malloc, pool_free};
+
+#ifdef WITH_GC
+static struct swiss_allocator swiss_allocator_gc = {gc_malloc, gc_free};
+#endif
+
+static struct swiss_allocator *swiss_allocator_for(enum allocator allocator)
+{
+    switch (allocator) {
+    case ALLOCATOR_COUNTING:
+        return &swiss_allocator_counting;
+    case ALLOCATOR_POOL:
+        return &swiss_allocator_pool;
+#ifdef WITH_GC
+    case ALLOCATOR_GC:
+        return &swiss_allocator_gc;
+#endif
+    default:
+        return &swiss_allocator_default;
+    }
+}
+
+static void *swiss_backend_create(enum key_type type, size_t capacity,
+                                  enum allocator allocator)
+{
+    if (type == KEY_STR)
+        return swiss_create(capacity, hash_string, eq_string,
+                            swiss_allocator_for(allocator));
+    return swiss_create(capacity, hash_int, eq_int,
+                        swiss_allocator_for(allocator));
+}
+
+static void swiss_backend_destroy(void *table) { swiss_delete(table); }
+
+static void swiss_backend_set(void *table, void *key, void *value)
+{
+    swiss_set(table, key, value);
+}
+
+static const void *swiss_backend_get(const void *table, void *key)
+{
+    return swiss_get(table, key);
+}
+
+static void swiss_backend_remove(void *table, void *key)
+{
+    swiss_remove(table, key);
+}
+
+static size_t swiss_backend_iterate(const void *table)
+{
+    size_t n = 0, pos = 0;
+    void *key, *value;
+    while (swiss_next(table, &pos, &key, &value)) {
+        n += value != NULL;
+    }
+    return n;
+}
+
+static uint32_t swiss_backend_hash(enum key_type type, const void *key)
+{
+    return type == KEY_STR ? hash_string(key) : hash_int(key);
+}
+
+const struct backend backend_swiss = {
+    .name = "swiss",
+    .key_types = KEY_INT | KEY_STR,
+    .allocators = ALLOCATOR_DEFAULT | ALLOCATOR_COUNTING | ALLOCATOR_GC |
+                  ALLOCATOR_POOL,
+    .create = swiss_backend_create,
+    .destroy = swiss_backend_destroy,
+    .set = swiss_backend_set,
+    .get = swiss_backend_get,
+    .remove = swiss_backend_remove,
+    .iterate = swiss_backend_iterate,
+    .hash = swiss_backend_hash,
+};
@@ -0,0 +1,274 @@
+#include "swiss.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#define GROUP 16
+#define MIN_CAPACITY GROUP
+
+/* control bytes: full slots hold H2 (0..127), markers have the sign bit */
+#define CTRL_EMPTY ((int8_t)-128)
+#define CTRL_DELETED ((int8_t)-2)
+
+struct slot {
+    void *key;
+    void *value;
+};
+
+struct swiss {
+    /*
+     * capacity + GROUP control bytes; the last GROUP mirror the first, so
+     * that a group can be loaded at any slot without wrapping around
+     */
+    int8_t *ctrl;
+    struct slot *slots; /* in the same block as ctrl */
+    size_t mask;        /* capacity - 1, capacity is a power of 2 */
+    size_t size;
+    size_t growth_left; /* EMPTY slots that may still be filled */
+    swiss_hash_fn *hash;
+    swiss_eq_fn *eq;
+    const struct swiss_allocator *ator;
+};
+
+struct swiss_allocator swiss_allocator_default = {malloc, free};
+
+/*
+ * Group operations: bit i of the result is set if control byte i of the
+ * group at g matches.
+ */
+#ifdef __SSE2__
+static inline uint32_t group_match(const int8_t *g, int8_t h2)
+{
+    __m128i ctrl = _mm_loadu_si128((const __m128i *)g);
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), ctrl));
+}
+
+static inline uint32_t group_empty_or_deleted(const int8_t *g)
+{
+    return _mm_movemask_epi8(_mm_loadu_si128((const __m128i *)g));
+}
+#else
+static inline uint32_t group_match(const int8_t *g, int8_t h2)
+{
+    uint32_t bits = 0;
+    for (int i = 0; i < GROUP; ++i) {
+        bits |= (uint32_t)(g[i] == h2) << i;
+    }
+    return bits;
+}
+
+static inline uint32_t group_empty_or_deleted(const int8_t *g)
+{
+    uint32_t bits = 0;
+    for (int i = 0; i < GROUP; ++i) {
+        bits |= (uint32_t)(g[i] < 0) << i;
+    }
+    return bits;
+}
+#endif
+
+static inline uint32_t group_empty(const int8_t *g)
+{
+    return group_match(g, CTRL_EMPTY);
+}
+
+/* H1 picks the first group, H2 goes into the control byte */
+static inline size_t h1(uint32_t hash)
+{
+    return (size_t)(((uint64_t)hash * 0x9e3779b97f4a7c15ull) >> 29);
+}
+
+static inline int8_t h2(uint32_t hash) { return hash & 0x7f; }
+
+/* Quadratic probing over groups; visits every group of the table */
+struct probe {
+    size_t pos;
+    size_t index;
+};
+
+static inline struct probe probe_start(const struct swiss *map, uint32_t hash)
+{
+    struct probe p = {h1(hash) & map->mask, 0};
+    return p;
+}
+
+static inline void probe_next(const struct swiss *map, struct probe *p)
+{
+    p->index += GROUP;
+    p->pos = (p->pos + p->index) & map->mask;
+}
+
+static size_t max_load(size_t capacity) { return capacity - capacity / 8; }
+
+static void set_ctrl(struct swiss *map, size_t i, int8_t c)
+{
+    map->ctrl[i] = c;
+    map->ctrl[((i - GROUP) & map->mask) + GROUP] = c;
+}
+
+static size_t find(const struct swiss *map, const void *key, uint32_t hash)
+{
+    struct probe p = probe_start(map, hash);
+    for (;;) {
+        const int8_t *g = map->ctrl + p.pos;
+        for (uint32_t m = group_match(g, h2(hash)); m; m &= m - 1) {
+            size_t i = (p.pos + __builtin_ctz(m)) & map->mask;
+            if (map->eq(key, map->slots[i].key))
+                return i;
+        }
+        if (group_empty(g))
+            return SIZE_MAX;
+        probe_next(map, &p);
+    }
+}
+
+static size_t find_non_full(const struct swiss *map, uint32_t hash)
+{
+    struct probe p = probe_start(map, hash);
+    for (;;) {
+        uint32_t m = group_empty_or_deleted(map->ctrl + p.pos);
+        if (m)
+            return (p.pos + __builtin_ctz(m)) & map->mask;
+        probe_next(map, &p);
+    }
+}
+
+static int alloc_table(struct swiss *map, size_t capacity)
+{
+    size_t ctrl_bytes = (capacity + GROUP + 7) & ~(size_t)7;
+    char *block =
+        map->ator->malloc(ctrl_bytes + capacity * sizeof(struct slot));
+    if (!block)
+        return -1;
+    map->ctrl = (int8_t *)block;
+    map->slots = (struct slot *)(block + ctrl_bytes);
+    map->mask = capacity - 1;
+    memset(map->ctrl, (uint8_t)CTRL_EMPTY, capacity + GROUP);
+    map->growth_left = max_load(capacity) - map->size;
+    return 0;
+}
+
+static int resize(struct swiss *map, size_t capacity)
+{
+    int8_t *old_ctrl = map->ctrl;
+    struct slot *old_slots = map->slots;
+    size_t old_capacity = map->mask + 1;
+    if (alloc_table(map, capacity))
+        return -1;
+    for (size_t i = 0; i < old_capacity; ++i) {
+        if (old_ctrl[i] < 0)
+            continue;
+        uint32_t hash = map->hash(old_slots[i].key);
+        size_t j = find_non_full(map, hash);
+        set_ctrl(map, j, h2(hash));
+        map->slots[j] = old_slots[i];
+    }
+    map->ator->free(old_ctrl);
+    return 0;
+}
+
+struct swiss *swiss_create(size_t capacity, swiss_hash_fn *hash,
+                           swiss_eq_fn *eq,
+                           const struct swiss_allocator *allocator)
+{
+    struct swiss *map = allocator->malloc(sizeof(struct swiss));
+    if (!map)
+        return NULL;
+    size_t n = MIN_CAPACITY;
+    while (max_load(n) < capacity) {
+        n *= 2;
+    }
+    map->size = 0;
+    map->hash = hash;
+    map->eq = eq;
+    map->ator = allocator;
+    if (alloc_table(map, n)) {
+        allocator->free(map);
+        return NULL;
+    }
+    return map;
+}
+
+void swiss_delete(struct swiss *map)
+{
+    map->ator->free(map->ctrl);
+    map->ator->free(map);
+}
+
+int swiss_set(struct swiss *map, void *key, void *value)
+{
+    uint32_t hash = map->hash(key);
+    size_t i = find(map, key, hash);
+    if (i != SIZE_MAX) {
+        map->slots[i].value = value;
+        return 0;
+    }
+    i = find_non_full(map, hash);
+    if (map->growth_left == 0 && map->ctrl[i] == CTRL_EMPTY) {
+        /* mostly tombstones: clean up in place, otherwise grow */
+        size_t capacity = map->mask + 1;
+        if (map->size > max_load(capacity) / 2)
+            capacity *= 2;
+        if (resize(map, capacity))
+            return -1;
+        i = find_non_full(map, hash);
+    }
+    map->growth_left -= map->ctrl[i] == CTRL_EMPTY;
+    map->size++;
+    set_ctrl(map, i, h2(hash));
+    map->slots[i].key = key;
+    map->slots[i].value = value;
+    return 0;
+}
+
+void *swiss_get(const struct swiss *map, const void *key)
+{
+    size_t i = find(map, key, map->hash(key));
+    return i == SIZE_MAX ? NULL : map->slots[i].value;
+}
+
+int swiss_remove(struct swiss *map, const void *key)
+{
+    size_t i = find(map, key, map->hash(key));
+    if (i == SIZE_MAX)
+        return 0;
+    map->size--;
+    /*
+     * If no group window containing slot i was ever full, no probe
+     * sequence went past it and the slot can become EMPTY again.
+     */
+    uint32_t before = group_empty(map->ctrl + ((i - GROUP) & map->mask));
+    uint32_t after = group_empty(map->ctrl + i);
+    int was_never_full = before && after &&
+                         (__builtin_clz(before) - (32 - GROUP)) +
+                                 __builtin_ctz(after) <
+                             GROUP;
+    if (was_never_full) {
+        set_ctrl(map, i, CTRL_EMPTY);
+        map->growth_left++;
+    } else {
+        set_ctrl(map, i, CTRL_DELETED);
+    }
+    return 1;
+}
+
+size_t swiss_size(const struct swiss *map) { return map->size; }
+
+int swiss_next(const struct swiss *map, size_t *pos, void **key,
+               void **value)
+{
+    for (size_t i = *pos; i <= map->mask; ++i) {
+        if (map->ctrl[i] >= 0) {
+            *key = map->slots[i].key;
+            *value = map->slots[i].value;
+            *pos = i + 1;
+            return 1;
+        }
+    }
+    *pos = map->mask + 1;
+    return 0;
+}
@@ -0,0 +1,57 @@
+#ifndef SWISS_H
+#define SWISS_H
+
+/*
+ * Open-addressing hash map in the style of Abseil's Swiss tables.
+ *
+ * Slots hold key/value pointers; a separate array of control bytes holds,
+ * per slot, either the 7 low bits of the key's hash (H2) or one of the
+ * markers EMPTY and DELETED. Lookups start at a slot derived from the rest
+ * of the hash (H1) and compare 16 control bytes at a time against H2 with
+ * SSE2, touching the slots only for candidate matches; a group with an
+ * EMPTY byte ends the probe sequence. Groups are probed quadratically.
+ * The table grows by doubling at a load factor of 7/8; removal leaves a
+ * DELETED tombstone, which rehashing in place clears.
+ *
+ * Keys and values are owned by the caller.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef uint32_t swiss_hash_fn(const void *key);
+/* returns non-zero if the keys are equal */
+typedef int swiss_eq_fn(const void *lhs, const void *rhs);
+
+struct swiss_allocator {
+    void *(*malloc)(const size_t size);
+    void (*free)(void *chunk);
+};
+
+extern struct swiss_allocator swiss_allocator_default;
+
+struct swiss;
+
+/* Create a map that holds `capacity` keys without growing */
+struct swiss *swiss_create(size_t capacity, swiss_hash_fn *hash,
+                           swiss_eq_fn *eq,
+                           const struct swiss_allocator *allocator);
+void swiss_delete(struct swiss *map);
+
+/* Insert or replace; returns 0 on success, -1 if out of memory */
+int swiss_set(struct swiss *map, void *key, void *value);
+/* The value of key, or NULL */
+void *swiss_get(const struct swiss *map, const void *key);
+/* Returns 1 if key was removed, 0 if it was not there */
+int swiss_remove(struct swiss *map, const void *key);
+size_t swiss_size(const struct swiss *map);
+
+/*
+ * Iterate over the entries in slot order, starting with *pos = 0: returns
+ * 1 and the next entry, or 0 at the end. The map must not be modified
+ * during iteration.
+ */
+int swiss_next(const struct swiss *map, size_t *pos, void **key,
+               void **value);
+
+#endif
@@ -1,35 +1,175 @@
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <time.h>
 
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
+
 #include "utils.h"
 
+int ticks_use_clock = 0;
+uint64_t ticks_overhead = 0;
+
+#if defined(__x86_64__) || defined(__i386__)
+/*
+ * The TSC is a clock if it ticks at a constant rate in all power states
+ * (invariant TSC) or if the kernel uses it as its clocksource, e.g. in VMs
+ * that do not report the invariant TSC flag.
+ */
+static int tsc_usable(void)
+{
+    unsigned int eax, ebx, ecx, edx;
+    if (!__get_cpuid(0x80000001, &eax, &ebx, &ecx, &edx) ||
+        !(edx & (1 << 27))) /* rdtscp */
+        return 0;
+    if (__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx) && (edx & (1 << 8)))
+        return 1;
+    char source[32] = "";
+    FILE *fp = fopen(
+        "/sys/devices/system/clocksource/clocksource0/current_clocksource",
+        "r");
+    if (fp) {
+        if (!fgets(source, sizeof(source), fp))
+            source[0] = '\0';
+        fclose(fp);
+    }
+    return strncmp(source, "tsc", 3) == 0;
+}
+#endif
+
+static double rate = 0.0;
+
+void timer_calibrate(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    ticks_use_clock = !tsc_usable();
+#endif
+    /* the smallest back-to-back difference, so that none goes negative */
+    ticks_overhead = 0;
+    uint64_t overhead = UINT64_MAX;
+    for (int i = 0; i < 10000; ++i) {
+        uint64_t begin = ticks_begin();
+        uint64_t ticks = ticks_end() - begin;
+        if (ticks < overhead)
+            overhead = ticks;
+    }
+    ticks_overhead = overhead;
+
+#if defined(__x86_64__) || defined(__i386__) || defined(__aarch64__)
+    if (!ticks_use_clock) {
+        /* count ticks over ~50ms of wall clock time */
+        uint64_t begin = clock_ticks(), now;
+        uint64_t t0 = ticks_end();
+        do {
+            now = clock_ticks();
+        } while (now - begin < 50000000);
+        rate = (ticks_end() - t0) / (double)(now - begin);
+        return;
+    }
+#endif
+    rate = 1.0;
+}
+
+double ticks_per_nsec(void)
+{
+    if (rate == 0.0)
+        timer_calibrate();
+    return rate;
+}
+
 void timer_start(struct TimeInterval *ti)
 {
-    ti->sec = 0;
-    ti->nsec = 0;
-    clock_gettime(CLOCK_MONOTONIC_RAW, &ti->begin);
+    ti->ticks = 0;
+    ti->begin = ticks_begin();
 }
 
 void timer_stop(struct TimeInterval *ti)
 {
-    clock_gettime(CLOCK_MONOTONIC_RAW, &ti->end);
-    ti->sec += ti->end.tv_sec - ti->begin.tv_sec;
-    ti->nsec += ti->end.tv_nsec - ti->begin.tv_nsec;
+    ti->end = ticks_end();
+    ti->ticks += ticks_elapsed(ti->begin, ti->end);
 }
 
 void timer_continue(struct TimeInterval *ti)
 {
-    clock_gettime(CLOCK_MONOTONIC_RAW, &ti->begin);
+    ti->begin = ticks_begin();
 }
 
 long timer_nsec(struct TimeInterval *ti)
 {
-    return ti->sec * 1000000000L + ti->nsec;
+    return (long)(ti->ticks / ticks_per_nsec());
 }
 
 void print_timer(struct TimeInterval *ti, const time_t timestamp,
                  const char *benchmark_id, size_t ix, const char *tag)
 {
-    printf("%ld, %s, %lu, %s,%lu\n", timestamp, benchmark_id, ix, tag,
-           ti->sec * 1000000000L + ti->nsec);
+    printf("%ld, %s, %lu, %s,%ld\n", timestamp, benchmark_id, ix, tag,
+           timer_nsec(ti));
+}
+
+void hist_reset(struct histogram *h)
+{
+    for (size_t i = 0; i < HIST_N_BUCKETS; ++i) {
+        h->counts[i] = 0;
+    }
+    h->n = 0;
+    h->max = 0;
+}
+
+void hist_merge(struct histogram *dst, const struct histogram *src)
+{
+    for (size_t i = 0; i < HIST_N_BUCKETS; ++i) {
+        dst->counts[i] += src->counts[i];
+    }
+    dst->n += src->n;
+    if (src->max > dst->max)
+        dst->max = src->max;
+}
+
+uint64_t hist_percentile(const struct histogram *h, double p)
+{
+    if (h->n == 0)
+        return 0;
+    uint64_t rank = p / 100.0 * h->n + 0.5;
+    if (rank < 1)
+        rank = 1;
+    uint64_t count = 0;
+    for (size_t i = 0; i < HIST_N_BUCKETS; ++i) {
+        count += h->counts[i];
+        if (count >= rank) {
+            if (i < 2 * HIST_SUB_BUCKETS)
+                return i;
+            int shift = i / HIST_SUB_BUCKETS - 1;
+            uint64_t lowest = (uint64_t)(i % HIST_SUB_BUCKETS +
+                                         HIST_SUB_BUCKETS)
+                              << shift;
+            uint64_t highest = lowest + ((uint64_t)1 << shift) - 1;
+            return highest < h->max ? highest : h->max;
+        }
+    }
+    return h->max;
+}
+
+void sampler_init(struct sampler *s, struct histogram *h, size_t every)
+{
+    s->h = h;
+    s->every = every;
+    s->countdown = every;
+    s->t0 = 0;
+    hist_reset(h);
+}
+
+void shuffle(void *base, size_t n, size_t size)
+{
+    char *a = base;
+    for (size_t i = n > 1 ? n - 1 : 0; i > 0; --i) {
+        size_t j = drand48() * (i + 1);
+        char *x = a + i * size, *y = a + j * size;
+        for (size_t k = 0; k < size; ++k) {
+            char tmp = x[k];
+            x[k] = y[k];
+            y[k] = tmp;
+        }
+    }
 }
@@ -1,13 +1,91 @@
 #ifndef HAMT_BENCH_UTILS
 #define HAMT_BENCH_UTILS
 
+#include <stddef.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <time.h>
 
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+/*
+ * Low-overhead tick counter for timing loops and individual operations:
+ * the TSC on x86, the virtual counter on aarch64. Where the TSC is not
+ * usable as a clock (no rdtscp, or neither an invariant TSC nor the
+ * kernel's clocksource) and on other architectures, ticks are nanoseconds
+ * of CLOCK_MONOTONIC_RAW.
+ *
+ * ticks_begin() and ticks_end() bracket a timed region and keep the
+ * processor from moving its instructions across them: lfence before the
+ * first read waits for earlier instructions, rdtscp waits for the region
+ * and lfence after it holds back later instructions. ticks_overhead is
+ * the smallest tick count of an empty region and is subtracted from
+ * every measurement.
+ *
+ * timer_calibrate() selects the clock, measures the overhead and the tick
+ * rate against CLOCK_MONOTONIC_RAW; the driver calls it at startup,
+ * before any thread starts timing, and ticks_per_nsec() on first use.
+ */
+extern int ticks_use_clock;
+extern uint64_t ticks_overhead;
+
+static inline uint64_t clock_ticks(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+    return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static inline uint64_t ticks_begin(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    if (!ticks_use_clock) {
+        _mm_lfence();
+        uint64_t ticks = __rdtsc();
+        _mm_lfence();
+        return ticks;
+    }
+#elif defined(__aarch64__)
+    uint64_t ticks;
+    __asm__ volatile("isb\n\tmrs %0, cntvct_el0" : "=r"(ticks)::"memory");
+    return ticks;
+#endif
+    return clock_ticks();
+}
+
+static inline uint64_t ticks_end(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    if (!ticks_use_clock) {
+        unsigned int aux;
+        uint64_t ticks = __rdtscp(&aux);
+        _mm_lfence();
+        return ticks;
+    }
+#elif defined(__aarch64__)
+    uint64_t ticks;
+    __asm__ volatile("isb\n\tmrs %0, cntvct_el0" : "=r"(ticks)::"memory");
+    return ticks;
+#endif
+    return clock_ticks();
+}
+
+/* Ticks between begin and end, less the timer's own overhead */
+static inline uint64_t ticks_elapsed(uint64_t begin, uint64_t end)
+{
+    uint64_t ticks = end - begin;
+    return ticks > ticks_overhead ? ticks - ticks_overhead : 0;
+}
+
+void timer_calibrate(void);
+double ticks_per_nsec(void);
+
+/* Accumulating interval timer: start, (stop, continue)*, stop */
 struct TimeInterval {
-    struct timespec begin, end;
-    time_t sec;
-    long nsec;
+    uint64_t begin, end; /* ticks at the last start and stop */
+    uint64_t ticks;      /* total between starts and stops */
 };
 
 void timer_start(struct TimeInterval *ti);
@@ -17,4 +95,89 @@ long timer_nsec(struct TimeInterval *ti);
 void print_timer(struct TimeInterval *ti, const time_t timestamp,
                  const char *benchmark_id, size_t ix, const char *tag);
 
+/*
+ * HDR-style log-linear histogram.
+ *
+ * Values below 2 * HIST_SUB_BUCKETS are recorded exactly; larger values
+ * fall into one of HIST_SUB_BUCKETS linear sub-buckets per power of two,
+ * i.e. with a relative error below 1 / HIST_SUB_BUCKETS (~3%).
+ */
+#define HIST_SUB_BITS 5
+#define HIST_SUB_BUCKETS (1 << HIST_SUB_BITS)
+#define HIST_N_BUCKETS ((64 - HIST_SUB_BITS + 1) * HIST_SUB_BUCKETS)
+
+struct histogram {
+    uint64_t counts[HIST_N_BUCKETS];
+    uint64_t n;
+    uint64_t max;
+};
+
+static inline size_t hist_index(uint64_t value)
+{
+    if (value < 2 * HIST_SUB_BUCKETS)
+        return value;
+    int shift = 63 - __builtin_clzll(value) - HIST_SUB_BITS;
+    return (shift + 1) * HIST_SUB_BUCKETS +
+           ((value >> shift) - HIST_SUB_BUCKETS);
+}
+
+static inline void hist_record(struct histogram *h, uint64_t value)
+{
+    h->counts[hist_index(value)]++;
+    h->n++;
+    if (value > h->max)
+        h->max = value;
+}
+
+void hist_reset(struct histogram *h);
+/* Add all samples of src to dst */
+void hist_merge(struct histogram *dst, const struct histogram *src);
+/* Highest value equivalent to the p-th percentile, 0 <= p <= 100 */
+uint64_t hist_percentile(const struct histogram *h, double p);
+
+/*
+ * Samples every `every`-th operation into a histogram, in ticks:
+ *
+ *   sampler_begin(&s);
+ *   operation();
+ *   sampler_end(&s);
+ *
+ * every == 0 disables sampling. The fences of a sampled operation also
+ * slow down its neighbours, so the driver samples in a pass of its own,
+ * after the timed one; a NULL sampler samples nothing and, passed as a
+ * constant into an inlined loop, costs nothing.
+ */
+struct sampler {
+    struct histogram *h;
+    size_t every;
+    size_t countdown;
+    uint64_t t0;
+};
+
+void sampler_init(struct sampler *s, struct histogram *h, size_t every);
+
+static inline void sampler_begin(struct sampler *s)
+{
+    if (s && s->countdown == 1)
+        s->t0 = ticks_begin();
+}
+
+static inline void sampler_end(struct sampler *s)
+{
+    if (!s)
+        return;
+    if (s->countdown == 1) {
+        hist_record(s->h, ticks_elapsed(s->t0, ticks_end()));
+        s->countdown = s->every + 1;
+    }
+    if (s->countdown)
+        s->countdown--;
+}
+
+/*
+ * Shuffle the n elements of `size` bytes at base in-place (Fisher-Yates,
+ * drawing from drand48()). Every key set and word list is shuffled by it.
+ */
+void shuffle(void *base, size_t n, size_t size);
+
 #endif
@@ -4,6 +4,8 @@
 #include <stdio.h>
 #include <string.h>
 
+#include "utils.h"
+
 const size_t WORDS_MAX = 235886;
 
 void words_load(char ***words, size_t n_words)
@@ -49,13 +51,7 @@ char **words_create_shuffled_refs(char **words, size_t n_words)
 {
     char **shuffled = calloc(n_words, sizeof(char *));
     memcpy(shuffled, words, n_words * sizeof(char *));
-    char *tmp;
-    for (size_t i = 0; i < n_words - 1; ++i) {
-        size_t j = drand48() * (i + 1);
-        tmp = shuffled[i];
-        shuffled[i] = shuffled[j];
-        shuffled[j] = tmp;
-    }
+    shuffle(shuffled, n_words, sizeof(char *));
     return shuffled;
 }
 
@@ -0,0 +1,354 @@
+#define _GNU_SOURCE
+
+#include "workload.h"
+
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+const char *phase_names[N_PHASES] = {"query",
+                                     "insert",
+                                     "remove",
+                                     "persistent_insert",
+                                     "persistent_remove",
+                                     "mixed",
+                                     "parallel_query",
+                                     "snapshot",
+                                     "memory",
+                                     "build",
+                                     "bulk_load",
+                                     "iterate",
+                                     "query_batch",
+                                     "hash",
+                                     "range"};
+
+void workload_init(struct workload *w)
+{
+    const size_t default_scales[] = {1e3, 1e4, 1e5, 1e6};
+    const size_t default_threads[] = {1, 2, 4, 8};
+    const size_t default_batches[] = {8, 16, 32, 64};
+    const size_t default_ranges[] = {10, 100, 1000};
+
+    memset(w, 0, sizeof(struct workload));
+    w->n_scales = sizeof(default_scales) / sizeof(default_scales[0]);
+    memcpy(w->scales, default_scales, sizeof(default_scales));
+    w->reps = 20;
+    w->max_reps = 100;
+    /* the mixed and multi-threaded phases are opt-in */
+    for (size_t i = 0; i <= PHASE_PERSISTENT_REMOVE; ++i) {
+        w->phases[i] = (enum phase)i;
+    }
+    w->n_phases = PHASE_PERSISTENT_REMOVE + 1;
+    w->phases[w->n_phases++] = PHASE_MEMORY;
+    w->update_fraction = 0.01;
+    w->latency_sample = 16;
+    w->counters = 1;
+    w->allocator = ALLOCATOR_DEFAULT;
+    w->seed = time(0);
+    mix_init(&w->mix);
+    w->n_threads = sizeof(default_threads) / sizeof(default_threads[0]);
+    memcpy(w->threads, default_threads, sizeof(default_threads));
+    w->n_batches = sizeof(default_batches) / sizeof(default_batches[0]);
+    memcpy(w->batches, default_batches, sizeof(default_batches));
+    w->n_ranges = sizeof(default_ranges) / sizeof(default_ranges[0]);
+    memcpy(w->ranges, default_ranges, sizeof(default_ranges));
+}
+
+/* Strip leading and trailing whitespace in-place */
+static char *trim(char *s)
+{
+    while (isspace((unsigned char)*s))
+        ++s;
+    char *end = s + strlen(s);
+    while (end > s && isspace((unsigned char)end[-1]))
+        --end;
+    *end = '\0';
+    return s;
+}
+
+static int parse_size(const char *s, size_t *out)
+{
+    /* strtod so that scales can be written as 1e6 */
+    char *end;
+    double d = strtod(s, &end);
+    if (end == s || *trim(end) != '\0' || d < 0)
+        return -1;
+    *out = (size_t)d;
+    return 0;
+}
+
+static int parse_phase(const char *s, enum phase *out)
+{
+    for (size_t i = 0; i < N_PHASES; ++i) {
+        if (strcmp(s, phase_names[i]) == 0) {
+            *out = (enum phase)i;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+/* Parse a comma-separated list of at most max positive sizes */
+static int set_sizes(size_t *sizes, size_t *n_sizes, size_t max, char *value)
+{
+    size_t n = 0;
+    char *saveptr;
+    for (char *tok = strtok_r(value, ",", &saveptr); tok;
+         tok = strtok_r(NULL, ",", &saveptr)) {
+        if (n == max || parse_size(trim(tok), &sizes[n]) || sizes[n] == 0)
+            return -1;
+        ++n;
+    }
+    *n_sizes = n;
+    return n > 0 ? 0 : -1;
+}
+
+static int set_phases(struct workload *w, char *value)
+{
+    size_t n = 0;
+    char *saveptr;
+    for (char *tok = strtok_r(value, ",", &saveptr); tok;
+         tok = strtok_r(NULL, ",", &saveptr)) {
+        if (n == WORKLOAD_MAX_PHASES || parse_phase(trim(tok), &w->phases[n]))
+            return -1;
+        ++n;
+    }
+    w->n_phases = n;
+    return n > 0 ? 0 : -1;
+}
+
+static int parse_fraction(const char *s, double *out)
+{
+    char *end;
+    double d = strtod(s, &end);
+    if (end == s || *end || d < 0.0 || d > 1.0)
+        return -1;
+    *out = d;
+    return 0;
+}
+
+/* Parse `op:weight, ...`; operations that are not listed get weight 0 */
+static int set_mix(struct mix *mix, char *value)
+{
+    double ratio[N_OPS] = {0};
+    char *saveptr;
+    for (char *tok = strtok_r(value, ",", &saveptr); tok;
+         tok = strtok_r(NULL, ",", &saveptr)) {
+        char *colon = strchr(tok, ':');
+        if (!colon)
+            return -1;
+        *colon = '\0';
+        char *name = trim(tok), *end;
+        int op = 0;
+        while (op < N_OPS && strcmp(name, op_type_names[op]) != 0)
+            ++op;
+        if (op == N_OPS)
+            return -1;
+        ratio[op] = strtod(colon + 1, &end);
+        if (end == colon + 1 || *trim(end) || ratio[op] < 0.0)
+            return -1;
+    }
+    double total = 0.0;
+    for (int i = 0; i < N_OPS; ++i) {
+        total += ratio[i];
+    }
+    if (total <= 0.0)
+        return -1;
+    memcpy(mix->ratio, ratio, sizeof(ratio));
+    return 0;
+}
+
+static int set_key_dist(struct mix *mix, const char *value)
+{
+    for (int i = 0; i <= DIST_LATEST; ++i) {
+        if (strcmp(value, key_dist_names[i]) == 0) {
+            mix->dist = (enum key_dist)i;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+static int set_key_type(struct workload *w, const char *value)
+{
+    w->words = strcmp(value, "words") == 0;
+    if (strcmp(value, "auto") == 0)
+        w->key_type = 0;
+    else if (strcmp(value, "int") == 0)
+        w->key_type = KEY_INT;
+    else if (strcmp(value, "str") == 0 || w->words)
+        w->key_type = KEY_STR;
+    else
+        return -1;
+    return 0;
+}
+
+int workload_set(struct workload *w, const char *key, const char *value)
+{
+    char *copy = strdup(value);
+    char *v = trim(copy);
+    char *end;
+    int rc = 0;
+
+    if (strcmp(key, "scales") == 0) {
+        rc = set_sizes(w->scales, &w->n_scales, WORKLOAD_MAX_SCALES, v);
+    } else if (strcmp(key, "reps") == 0) {
+        rc = parse_size(v, &w->reps) || w->reps == 0 ? -1 : 0;
+    } else if (strcmp(key, "ci") == 0) {
+        rc = parse_fraction(v, &w->ci);
+    } else if (strcmp(key, "max_reps") == 0) {
+        rc = parse_size(v, &w->max_reps);
+    } else if (strcmp(key, "phases") == 0) {
+        rc = set_phases(w, v);
+    } else if (strcmp(key, "update_fraction") == 0) {
+        w->update_fraction = strtod(v, &end);
+        rc = end == v || *end || w->update_fraction <= 0.0 ||
+                     w->update_fraction > 1.0
+                 ? -1
+                 : 0;
+    } else if (strcmp(key, "keys") == 0) {
+        rc = set_key_type(w, v);
+    } else if (strcmp(key, "latency_sample") == 0) {
+        rc = parse_size(v, &w->latency_sample);
+    } else if (strcmp(key, "counters") == 0) {
+        rc = parse_size(v, &w->counters) || w->counters > 1 ? -1 : 0;
+    } else if (strcmp(key, "allocator") == 0) {
+        rc = allocator_parse(v, &w->allocator);
+    } else if (strcmp(key, "layout") == 0) {
+        rc = layout_parse(v, &w->layout);
+    } else if (strcmp(key, "hash") == 0) {
+        rc = hash_parse(v, &w->hash);
+    } else if (strcmp(key, "relayout_every") == 0) {
+        rc = parse_size(v, &w->relayout_every);
+    } else if (strcmp(key, "mix") == 0) {
+        rc = set_mix(&w->mix, v);
+    } else if (strcmp(key, "distribution") == 0) {
+        rc = set_key_dist(&w->mix, v);
+    } else if (strcmp(key, "zipf_theta") == 0) {
+        rc = parse_fraction(v, &w->mix.zipf_theta) ||
+                     w->mix.zipf_theta == 0.0 || w->mix.zipf_theta == 1.0
+                 ? -1
+                 : 0;
+    } else if (strcmp(key, "hot_set") == 0) {
+        rc = parse_fraction(v, &w->mix.hot_set);
+    } else if (strcmp(key, "hot_ops") == 0) {
+        rc = parse_fraction(v, &w->mix.hot_ops);
+    } else if (strcmp(key, "ops") == 0) {
+        rc = parse_size(v, &w->mix.n_ops);
+    } else if (strcmp(key, "threads") == 0) {
+        rc = set_sizes(w->threads, &w->n_threads, WORKLOAD_MAX_THREADS, v);
+    } else if (strcmp(key, "batch") == 0) {
+        rc = set_sizes(w->batches, &w->n_batches, WORKLOAD_MAX_BATCHES, v);
+    } else if (strcmp(key, "range") == 0) {
+        rc = set_sizes(w->ranges, &w->n_ranges, WORKLOAD_MAX_RANGES, v);
+    } else if (strcmp(key, "seed") == 0) {
+        w->seed = strtol(v, &end, 10);
+        rc = end == v || *end ? -1 : 0;
+    } else if (strcmp(key, "tag") == 0) {
+        rc = strlen(v) < WORKLOAD_MAX_TAG ? 0 : -1;
+        if (rc == 0)
+            strcpy(w->tag, v);
+    } else {
+        fprintf(stderr, "unknown workload parameter: %s\n", key);
+        free(copy);
+        return -1;
+    }
+    if (rc)
+        fprintf(stderr, "invalid value for %s: %s\n", key, value);
+    free(copy);
+    return rc;
+}
+
+int workload_parse_line(struct workload *w, const char *line)
+{
+    char *copy = strdup(line);
+    char *comment = strchr(copy, '#');
+    /* the tag is free-form and may contain '#' */
+    if (comment && strncmp(trim(copy), "tag", 3) != 0)
+        *comment = '\0';
+    char *s = trim(copy);
+    int rc = 0;
+    if (*s != '\0') {
+        char *eq = strchr(s, '=');
+        if (!eq) {
+            fprintf(stderr, "expected key = value: %s\n", line);
+            rc = -1;
+        } else {
+            *eq = '\0';
+            rc = workload_set(w, trim(s), eq + 1);
+        }
+    }
+    free(copy);
+    return rc;
+}
+
+int workload_load(struct workload *w, const char *path)
+{
+    FILE *fp = fopen(path, "r");
+    if (!fp) {
+        fprintf(stderr, "failed to open workload file: %s\n", path);
+        return -1;
+    }
+    char *line = NULL;
+    size_t len = 0;
+    int rc = 0;
+    while (rc == 0 && getline(&line, &len, fp) != -1) {
+        rc = workload_parse_line(w, line);
+    }
+    free(line);
+    fclose(fp);
+    return rc;
+}
+
+void workload_print(FILE *fp, const struct workload *w)
+{
+    fprintf(fp, "scales = ");
+    for (size_t i = 0; i < w->n_scales; ++i) {
+        fprintf(fp, "%s%lu", i ? ", " : "", w->scales[i]);
+    }
+    fprintf(fp, "\nreps = %lu\nci = %.17g\nmax_reps = %lu\nphases = ", w->reps,
+            w->ci, w->max_reps);
+    for (size_t i = 0; i < w->n_phases; ++i) {
+        fprintf(fp, "%s%s", i ? ", " : "", phase_names[w->phases[i]]);
+    }
+    fprintf(fp,
+            "\nupdate_fraction = %.17g\nkeys = %s\nlatency_sample = %lu\n"
+            "counters = %lu\nallocator = %s\nlayout = %s\nhash = %s\n"
+            "seed = %ld\n",
+            w->update_fraction,
+            w->words                 ? "words"
+            : w->key_type == KEY_INT ? "int"
+            : w->key_type == KEY_STR ? "str"
+                                     : "auto",
+            w->latency_sample, w->counters, allocator_name(w->allocator),
+            layout_name(w->layout), hash_name(w->hash), w->seed);
+    fprintf(fp, "mix = ");
+    for (int i = 0, first = 1; i < N_OPS; ++i) {
+        if (w->mix.ratio[i] > 0.0) {
+            fprintf(fp, "%s%s:%.17g", first ? "" : ", ", op_type_names[i],
+                    w->mix.ratio[i]);
+            first = 0;
+        }
+    }
+    fprintf(fp,
+            "\ndistribution = %s\nzipf_theta = %.17g\nhot_set = %.17g\n"
+            "hot_ops = %.17g\nops = %lu\nrelayout_every = %lu\n",
+            key_dist_names[w->mix.dist], w->mix.zipf_theta, w->mix.hot_set,
+            w->mix.hot_ops, w->mix.n_ops, w->relayout_every);
+    fprintf(fp, "threads = ");
+    for (size_t i = 0; i < w->n_threads; ++i) {
+        fprintf(fp, "%s%lu", i ? ", " : "", w->threads[i]);
+    }
+    fprintf(fp, "\nbatch = ");
+    for (size_t i = 0; i < w->n_batches; ++i) {
+        fprintf(fp, "%s%lu", i ? ", " : "", w->batches[i]);
+    }
+    fprintf(fp, "\nrange = ");
+    for (size_t i = 0; i < w->n_ranges; ++i) {
+        fprintf(fp, "%s%lu", i ? ", " : "", w->ranges[i]);
+    }
+    fprintf(fp, "\n");
+    if (w->tag[0])
+        fprintf(fp, "tag = %s\n", w->tag);
+}
@@ -0,0 +1,126 @@
+#ifndef WORKLOAD_H
+#define WORKLOAD_H
+
+/*
+ * Declarative workload descriptions.
+ *
+ * A workload is a list of `key = value` lines, read from a file (-w) or
+ * given on the command line (-o key=value). Blank lines and lines starting
+ * with '#' are ignored. workload_print() writes the canonical form, which
+ * can be fed back to the driver to rerun an experiment exactly.
+ *
+ *   scales = 1e3, 1e4, 1e5, 1e6     # table sizes
+ *   reps = 20                        # repetitions per (phase, scale)
+ *   ci = 0                           # repeat reps until the 95% CI of the
+ *                                    # median is within ci of it, 0 = off
+ *   max_reps = 100                   # bound on the repetitions with ci
+ *   phases = query, insert, remove   # phases, in execution order
+ *   update_fraction = 0.01           # share of scale inserted/removed
+ *   keys = auto                      # auto | int | str | words
+ *   latency_sample = 16              # time every n-th operation, 0 = off
+ *   counters = 1                     # read hardware counters, 0 = off
+ *   allocator = default              # default | counting | gc | pool | slab
+ *   layout = none                    # none | bfs | veb, slab trees only
+ *   hash = murmur3                   # key hash of libhamt, see hash.h
+ *   seed = 1703240024                # drand48 seed, defaults to time(0)
+ *   tag = nightly                    # free-form experiment tag
+ *
+ * The mixed phase runs a YCSB-style operation stream (see generator.h):
+ *
+ *   mix = get:95, set:5              # get | set | insert | remove weights
+ *   distribution = zipfian           # uniform | zipfian | hotspot | latest
+ *   zipf_theta = 0.99                # zipfian/latest skew
+ *   hot_set = 0.2                    # hotspot: fraction of hot keys
+ *   hot_ops = 0.8                    # hotspot: fraction of hot operations
+ *   ops = 0                          # operations per rep, 0 means scale
+ *   relayout_every = 0               # relayout every n ops, 0 = off
+ *
+ * The parallel_query and snapshot phases run concurrent readers (see
+ * parallel.c):
+ *
+ *   threads = 1, 2, 4, 8             # reader thread counts
+ *
+ * The query_batch phase looks up keys in batches (see get_batch in
+ * backend.h):
+ *
+ *   batch = 8, 16, 32, 64            # keys per batch
+ *
+ * The range phase scans consecutive keys (see range in backend.h):
+ *
+ *   range = 10, 100, 1000            # keys per scan
+ */
+
+#include <stddef.h>
+#include <stdio.h>
+
+#include "alloc.h"
+#include "generator.h"
+#include "hash.h"
+#include "keys.h"
+
+#define WORKLOAD_MAX_SCALES 32
+#define WORKLOAD_MAX_PHASES 32
+#define WORKLOAD_MAX_THREADS 32
+#define WORKLOAD_MAX_BATCHES 32
+#define WORKLOAD_MAX_RANGES 32
+#define WORKLOAD_MAX_TAG 256
+
+enum phase {
+    PHASE_QUERY,
+    PHASE_INSERT,
+    PHASE_REMOVE,
+    PHASE_PERSISTENT_INSERT,
+    PHASE_PERSISTENT_REMOVE,
+    PHASE_MIXED,
+    PHASE_PARALLEL_QUERY,
+    PHASE_SNAPSHOT,
+    PHASE_MEMORY,
+    PHASE_BUILD,
+    PHASE_BULK_LOAD,
+    PHASE_ITERATE,
+    PHASE_QUERY_BATCH,
+    PHASE_HASH,
+    PHASE_RANGE,
+    N_PHASES
+};
+
+extern const char *phase_names[N_PHASES];
+
+struct workload {
+    size_t scales[WORKLOAD_MAX_SCALES];
+    size_t n_scales;
+    size_t reps;
+    double ci;       /* target relative CI half-width, 0 = fixed reps */
+    size_t max_reps; /* bound on the adaptive repetitions */
+    enum phase phases[WORKLOAD_MAX_PHASES];
+    size_t n_phases;
+    double update_fraction;
+    enum key_type key_type; /* 0 selects the backend's preferred type */
+    int words;              /* string keys from the word list */
+    struct mix mix;
+    size_t threads[WORKLOAD_MAX_THREADS];
+    size_t n_threads;
+    size_t batches[WORKLOAD_MAX_BATCHES];
+    size_t n_batches;
+    size_t ranges[WORKLOAD_MAX_RANGES];
+    size_t n_ranges;
+    size_t latency_sample; /* sample every n-th operation, 0 disables */
+    size_t counters;       /* read hardware performance counters */
+    enum allocator allocator;
+    enum layout layout;     /* node order after loading, see alloc.h */
+    size_t relayout_every;  /* mixed: relayout every n-th operation */
+    enum hash hash;
+    long seed;
+    char tag[WORKLOAD_MAX_TAG];
+};
+
+void workload_init(struct workload *w);
+/* Set a single workload parameter; returns 0 on success, -1 on error */
+int workload_set(struct workload *w, const char *key, const char *value);
+/* Parse a `key = value` line; returns 0 on success, -1 on error */
+int workload_parse_line(struct workload *w, const char *line);
+/* Load a workload file; returns 0 on success, -1 on error */
+int workload_load(struct workload *w, const char *path);
+void workload_print(FILE *fp, const struct workload *w);
+
+#endif
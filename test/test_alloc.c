@@ -0,0 +1,178 @@
+#include "minunit.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../src/alloc.c"
+
+MU_TEST_CASE(test_counting_alloc)
+{
+    printf(". testing the counting allocator\n");
+    alloc_stats_reset();
+    void *a = counting_malloc(100);
+    void *b = counting_malloc(1000);
+    MU_ASSERT(alloc_stats.n_allocs == 2, "Wrong allocation count");
+    MU_ASSERT(alloc_stats.live >= 1100, "Live bytes below requested size");
+    size_t live = alloc_stats.live;
+    counting_free(a);
+    MU_ASSERT(alloc_stats.live < live, "Free not accounted");
+    MU_ASSERT(alloc_stats.peak == live, "Wrong peak");
+    counting_free(b);
+    MU_ASSERT(alloc_stats.live == 0, "Leak after freeing all blocks");
+    MU_ASSERT(alloc_stats.peak == live, "Peak not retained");
+    return 0;
+}
+
+MU_TEST_CASE(test_counting_realloc)
+{
+    printf(". testing counting realloc\n");
+    alloc_stats_reset();
+    char *p = counting_realloc(NULL, 16);
+    strcpy(p, "hamt");
+    p = counting_realloc(p, 4096);
+    MU_ASSERT(strcmp(p, "hamt") == 0, "Realloc lost the contents");
+    MU_ASSERT(alloc_stats.live >= 4096, "Realloc not accounted");
+    MU_ASSERT(alloc_stats.n_allocs == 2, "Wrong allocation count");
+    counting_free(p);
+    MU_ASSERT(alloc_stats.live == 0, "Leak after realloc");
+    return 0;
+}
+
+MU_TEST_CASE(test_counting_aligned)
+{
+    printf(". testing aligned counting\n");
+    alloc_stats_reset();
+    void *p = counting_malloc_aligned(256);
+    MU_ASSERT(((uintptr_t)p & (ALLOC_LINE - 1)) == 0, "Block not aligned");
+    MU_ASSERT(alloc_stats.live >= 256, "Aligned block not accounted");
+    counting_free(p);
+    MU_ASSERT(alloc_stats.live == 0, "Leak after freeing aligned block");
+    return 0;
+}
+
+MU_TEST_CASE(test_interpose)
+{
+    printf(". testing malloc interposition\n");
+    alloc_stats_reset();
+    /*
+     * Volatile throughout: the compiler may drop malloc/free pairs whose
+     * blocks are never used, and assumes that they leave alloc_stats alone.
+     */
+    volatile struct alloc_stats *counters = &alloc_stats;
+    void *volatile before = malloc(64);
+    if (alloc_interpose_start() != 0) {
+        printf("  (no build/libmemcount.so on this platform)\n");
+        free(before);
+        return 0;
+    }
+    void *volatile p = calloc(10, 100);
+    MU_ASSERT(counters->n_allocs == 1, "calloc not accounted");
+    MU_ASSERT(counters->live >= 1000, "Wrong live bytes");
+    free(p);
+    MU_ASSERT(counters->live == 0, "free not accounted");
+    /* blocks from before the reset must not underflow the counters */
+    free(before);
+    MU_ASSERT(counters->live == 0, "Underflow on foreign block");
+    p = aligned_alloc(64, 128);
+    MU_ASSERT(((uintptr_t)p & 63) == 0, "aligned_alloc not aligned");
+    free(p);
+    void *q;
+    MU_ASSERT(posix_memalign(&q, 64, 256) == 0, "posix_memalign failed");
+    p = q;
+    MU_ASSERT(counters->n_allocs == 3, "Aligned blocks not accounted");
+    MU_ASSERT(counters->live >= 256, "Wrong live bytes");
+    free(p);
+    MU_ASSERT(counters->live == 0, "Aligned free not accounted");
+    alloc_interpose_stop();
+    p = malloc(64);
+    free(p);
+    MU_ASSERT(counters->n_allocs == 3, "Counted after stop");
+    return 0;
+}
+
+MU_TEST_CASE(test_pool)
+{
+    printf(". testing the pool allocator\n");
+    char *a = pool_malloc(24);
+    char *b = pool_malloc(24);
+    MU_ASSERT(a && b && a != b, "Pool returned overlapping blocks");
+    MU_ASSERT(((uintptr_t)a & 7) == 0, "Pool block not 8-byte aligned");
+    memset(a, 0xaa, 24);
+    memset(b, 0xbb, 24);
+    MU_ASSERT((unsigned char)a[23] == 0xaa, "Blocks overlap");
+    pool_free(a);
+    /* the free list hands out the most recently freed block first */
+    MU_ASSERT(pool_malloc(20) == a, "Freed block not recycled");
+    pool_free(b);
+    MU_ASSERT(pool_malloc(40) != b, "Block reused for a larger class");
+    return 0;
+}
+
+MU_TEST_CASE(test_pool_realloc)
+{
+    printf(". testing pool realloc\n");
+    char *p = pool_realloc(NULL, 8);
+    strcpy(p, "hamt");
+    MU_ASSERT(pool_realloc(p, 3) == p, "Shrinking moved the block");
+    p = pool_realloc(p, 100);
+    MU_ASSERT(strcmp(p, "hamt") == 0, "Growing lost the contents");
+    p = pool_realloc(p, 2 * POOL_MAX_SIZE);
+    MU_ASSERT(strcmp(p, "hamt") == 0, "Moving to malloc lost the contents");
+    p = pool_realloc(p, 4 * POOL_MAX_SIZE);
+    MU_ASSERT(strcmp(p, "hamt") == 0, "Large realloc lost the contents");
+    p = pool_realloc(p, 16);
+    MU_ASSERT(strcmp(p, "hamt") == 0, "Moving to the pool lost the contents");
+    pool_free(p);
+    return 0;
+}
+
+MU_TEST_CASE(test_pool_aligned)
+{
+    printf(". testing the aligned pool\n");
+    char *a = pool_malloc_aligned(64);
+    char *b = pool_malloc_aligned(64);
+    char *c = pool_malloc_aligned(200);
+    MU_ASSERT(a && b && c, "Aligned pool out of memory");
+    MU_ASSERT(((uintptr_t)a & (ALLOC_LINE - 1)) == 0 &&
+                  ((uintptr_t)b & (ALLOC_LINE - 1)) == 0 &&
+                  ((uintptr_t)c & (ALLOC_LINE - 1)) == 0,
+              "Pool block not aligned");
+    MU_ASSERT(b - a >= 64 || a - b >= 64, "Blocks overlap");
+    memset(c, 0xcc, 200);
+    pool_free_aligned(a);
+    pool_free_aligned(c);
+    /* blocks go back to the free list of their own class */
+    MU_ASSERT(pool_malloc_aligned(10) == a, "Freed block not recycled");
+    MU_ASSERT(pool_malloc_aligned(256) == c, "Class lost on free");
+    MU_ASSERT(pool_malloc_aligned(POOL_MAX_ALIGNED + 1) == NULL,
+              "Oversized block from the aligned pool");
+    pool_free_aligned(b);
+    return 0;
+}
+
+int mu_tests_run = 0;
+
+MU_TEST_SUITE(test_suite)
+{
+    MU_RUN_TEST(test_counting_alloc);
+    MU_RUN_TEST(test_counting_realloc);
+    MU_RUN_TEST(test_counting_aligned);
+    MU_RUN_TEST(test_interpose);
+    MU_RUN_TEST(test_pool);
+    MU_RUN_TEST(test_pool_realloc);
+    MU_RUN_TEST(test_pool_aligned);
+    return 0;
+}
+
+int main()
+{
+    printf("---=[ Allocator tests\n");
+    char *result = test_suite();
+    if (result != 0) {
+        printf("%s\n", result);
+    } else {
+        printf("All tests passed.\n");
+    }
+    printf("Tests run: %d\n", mu_tests_run);
+    return result != 0;
+}
@@ -0,0 +1,274 @@
+#include "minunit.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../src/bptree/bptree.c"
+
+#define N_KEYS 100000
+
+static int keys[N_KEYS];
+static char str_keys[N_KEYS][8];
+
+/* the even numbers 0, 2, ... in random order, so that odd keys miss */
+static void shuffled_keys(void)
+{
+    srand(1);
+    for (int i = 0; i < N_KEYS; ++i) {
+        keys[i] = 2 * i;
+    }
+    for (int i = N_KEYS - 1; i > 0; --i) {
+        int j = rand() % (i + 1);
+        int tmp = keys[i];
+        keys[i] = keys[j];
+        keys[j] = tmp;
+    }
+}
+
+static char *check_int_tree(size_t node_size)
+{
+    struct bptree *t =
+        bptree_create(BPTREE_INT, node_size, &bptree_allocator_default);
+    MU_ASSERT(t, "Create failed");
+    for (int i = 0; i < N_KEYS; ++i) {
+        MU_ASSERT(bptree_set(t, &keys[i], &keys[i]) == 0, "Set failed");
+    }
+    MU_ASSERT(bptree_size(t) == N_KEYS, "Wrong size");
+    MU_ASSERT(bptree_height(t) > 2, "Tree did not grow");
+    for (int i = 0; i < N_KEYS; ++i) {
+        int *v = bptree_get(t, &keys[i]);
+        MU_ASSERT(v && *v == keys[i], "Key not found");
+        int odd = keys[i] + 1;
+        MU_ASSERT(bptree_get(t, &odd) == NULL, "Found a missing key");
+    }
+    int negative = -1;
+    MU_ASSERT(bptree_get(t, &negative) == NULL, "Found a negative key");
+    /* replacing keeps the size */
+    bptree_set(t, &keys[7], &keys[8]);
+    MU_ASSERT(bptree_size(t) == N_KEYS, "Replace changed the size");
+    MU_ASSERT(bptree_get(t, &keys[7]) == &keys[8], "Value not replaced");
+    bptree_set(t, &keys[7], &keys[7]);
+    bptree_delete(t);
+    return 0;
+}
+
+MU_TEST_CASE(test_set_get)
+{
+    printf(". testing set and get with 64 and 256 byte nodes\n");
+    shuffled_keys();
+    char *result = check_int_tree(64);
+    if (!result)
+        result = check_int_tree(256);
+    if (!result)
+        result = check_int_tree(4096);
+    return result;
+}
+
+MU_TEST_CASE(test_create)
+{
+    printf(". testing node sizes\n");
+    MU_ASSERT(!bptree_create(BPTREE_INT, 32, &bptree_allocator_default),
+              "Accepted a node smaller than a cache line");
+    MU_ASSERT(!bptree_create(BPTREE_INT, 100, &bptree_allocator_default),
+              "Accepted a node that is not a multiple of 64");
+    struct bptree *t =
+        bptree_create(BPTREE_STR, 64, &bptree_allocator_default);
+    /* every node fits its node size */
+    MU_ASSERT(HEADER + t->leaf_ptrs + t->leaf_cap * sizeof(void *) <= 64,
+              "Leaf too large");
+    size_t inner = HEADER + t->inner_ptrs + (t->inner_cap + 1) * sizeof(void *);
+    MU_ASSERT(inner <= 64, "Inner node too large");
+    MU_ASSERT(t->inner_cap >= 2 && t->leaf_cap >= 2, "Nodes too small");
+    bptree_delete(t);
+    return 0;
+}
+
+MU_TEST_CASE(test_seek)
+{
+    printf(". testing ordered iteration and seek\n");
+    struct bptree *t =
+        bptree_create(BPTREE_INT, 64, &bptree_allocator_default);
+    for (int i = 0; i < N_KEYS; ++i) {
+        bptree_set(t, &keys[i], &keys[i]);
+    }
+    struct bptree_cursor cursor;
+    void *value;
+    int expected = 0;
+    bptree_seek(t, NULL, &cursor);
+    while (bptree_next(&cursor, &value)) {
+        MU_ASSERT(*(int *)value == expected, "Iteration out of order");
+        expected += 2;
+    }
+    MU_ASSERT(expected == 2 * N_KEYS, "Iteration ended early");
+    /* a missing key starts the scan at its successor */
+    int from = 1001;
+    bptree_seek(t, &from, &cursor);
+    for (int k = 1002; k < 1100; k += 2) {
+        MU_ASSERT(bptree_next(&cursor, &value) && *(int *)value == k,
+                  "Wrong scan from a missing key");
+    }
+    from = 2 * N_KEYS;
+    bptree_seek(t, &from, &cursor);
+    MU_ASSERT(!bptree_next(&cursor, &value), "Scanned past the largest key");
+    bptree_delete(t);
+    return 0;
+}
+
+MU_TEST_CASE(test_remove)
+{
+    printf(". testing remove\n");
+    struct bptree *t =
+        bptree_create(BPTREE_INT, 64, &bptree_allocator_default);
+    for (int i = 0; i < N_KEYS; ++i) {
+        bptree_set(t, &keys[i], &keys[i]);
+    }
+    /* empties whole leaves, which scans must step over */
+    for (int i = 0; i < N_KEYS; ++i) {
+        if (keys[i] % 1000 >= 10)
+            MU_ASSERT(bptree_remove(t, &keys[i]) == 1, "Remove failed");
+    }
+    int removed = 20;
+    MU_ASSERT(bptree_remove(t, &removed) == 0, "Removed a key twice");
+    MU_ASSERT(bptree_size(t) == N_KEYS / 100, "Wrong size after remove");
+    struct bptree_cursor cursor;
+    void *value;
+    size_t n = 0;
+    int last = -1;
+    bptree_seek(t, NULL, &cursor);
+    while (bptree_next(&cursor, &value)) {
+        int k = *(int *)value;
+        MU_ASSERT(k > last && k % 1000 < 10, "Wrong key after remove");
+        last = k;
+        n++;
+    }
+    MU_ASSERT(n == N_KEYS / 100, "Wrong number of keys after remove");
+    /* removed keys can be inserted again */
+    for (int i = 0; i < N_KEYS; ++i) {
+        bptree_set(t, &keys[i], &keys[i]);
+    }
+    MU_ASSERT(bptree_size(t) == N_KEYS, "Wrong size after reinsert");
+    for (int i = 0; i < N_KEYS; ++i) {
+        MU_ASSERT(bptree_get(t, &keys[i]) == &keys[i], "Lost a key");
+    }
+    bptree_delete(t);
+    return 0;
+}
+
+MU_TEST_CASE(test_str)
+{
+    printf(". testing string keys\n");
+    struct bptree *t =
+        bptree_create(BPTREE_STR, 256, &bptree_allocator_default);
+    for (int i = 0; i < N_KEYS; ++i) {
+        snprintf(str_keys[i], sizeof(str_keys[i]), "%d", keys[i]);
+        bptree_set(t, str_keys[i], str_keys[i]);
+    }
+    MU_ASSERT(bptree_size(t) == N_KEYS, "Wrong size");
+    for (int i = 0; i < N_KEYS; ++i) {
+        char key[8];
+        snprintf(key, sizeof(key), "%d", keys[i]);
+        MU_ASSERT(bptree_get(t, key) == str_keys[i], "Key not found");
+    }
+    MU_ASSERT(bptree_get(t, "1") == NULL, "Found a missing key");
+    /* strings sort lexicographically */
+    struct bptree_cursor cursor;
+    void *value;
+    const char *last = "";
+    size_t n = 0;
+    bptree_seek(t, NULL, &cursor);
+    while (bptree_next(&cursor, &value)) {
+        MU_ASSERT(strcmp(last, value) < 0, "Iteration out of order");
+        last = value;
+        n++;
+    }
+    MU_ASSERT(n == N_KEYS, "Wrong number of keys");
+    /* "1001" is missing, "10010" the next key */
+    bptree_seek(t, "1001", &cursor);
+    MU_ASSERT(bptree_next(&cursor, &value) && strcmp(value, "10010") == 0,
+              "Wrong scan start");
+    bptree_delete(t);
+    return 0;
+}
+
+MU_TEST_CASE(test_bulk_load)
+{
+    printf(". testing bulk load\n");
+    static void *refs[N_KEYS];
+    for (int i = 0; i < N_KEYS; ++i) {
+        refs[i] = &keys[i];
+    }
+    struct bptree *t = bptree_bulk_load(
+        BPTREE_INT, 64, &bptree_allocator_default, refs, refs, 0);
+    MU_ASSERT(t && bptree_size(t) == 0, "Empty load not empty");
+    bptree_delete(t);
+    for (size_t node_size = 64; node_size <= 256; node_size *= 4) {
+        t = bptree_bulk_load(BPTREE_INT, node_size, &bptree_allocator_default,
+                             refs, refs, N_KEYS);
+        MU_ASSERT(t && bptree_size(t) == N_KEYS, "Wrong size");
+        MU_ASSERT(bptree_height(t) > 2, "Tree not built up");
+        for (int i = 0; i < N_KEYS; ++i) {
+            MU_ASSERT(bptree_get(t, &keys[i]) == &keys[i], "Key not found");
+            int odd = keys[i] + 1;
+            MU_ASSERT(bptree_get(t, &odd) == NULL, "Found a missing key");
+        }
+        struct bptree_cursor cursor;
+        void *value;
+        int last = -1;
+        size_t n = 0;
+        bptree_seek(t, NULL, &cursor);
+        while (bptree_next(&cursor, &value)) {
+            MU_ASSERT(*(int *)value > last, "Leaves out of order");
+            last = *(int *)value;
+            n++;
+        }
+        MU_ASSERT(n == N_KEYS, "Leaf list incomplete");
+        /* the packed tree splits like any other */
+        static int odd[N_KEYS];
+        for (int i = 0; i < N_KEYS; ++i) {
+            odd[i] = keys[i] + 1;
+            MU_ASSERT(bptree_set(t, &odd[i], &odd[i]) == 0, "Set failed");
+        }
+        MU_ASSERT(bptree_size(t) == 2 * N_KEYS, "Wrong size after set");
+        for (int i = 0; i < N_KEYS; ++i) {
+            MU_ASSERT(bptree_get(t, &keys[i]) == &keys[i] &&
+                          bptree_get(t, &odd[i]) == &odd[i],
+                      "Key lost after set");
+        }
+        bptree_delete(t);
+    }
+    /* of duplicate keys, the last one wins */
+    int dup[3] = {5, 7, 5};
+    void *dup_refs[3] = {&dup[0], &dup[1], &dup[2]};
+    t = bptree_bulk_load(BPTREE_INT, 64, &bptree_allocator_default, dup_refs,
+                         dup_refs, 3);
+    MU_ASSERT(bptree_size(t) == 2, "Duplicate not dropped");
+    MU_ASSERT(bptree_get(t, &dup[0]) == &dup[2], "Wrong duplicate kept");
+    bptree_delete(t);
+    return 0;
+}
+
+int mu_tests_run = 0;
+
+MU_TEST_SUITE(test_suite)
+{
+    MU_RUN_TEST(test_set_get);
+    MU_RUN_TEST(test_create);
+    MU_RUN_TEST(test_seek);
+    MU_RUN_TEST(test_remove);
+    MU_RUN_TEST(test_str);
+    MU_RUN_TEST(test_bulk_load);
+    return 0;
+}
+
+int main()
+{
+    printf("---=[ B+tree tests\n");
+    char *result = test_suite();
+    if (result != 0) {
+        printf("%s\n", result);
+    } else {
+        printf("All tests passed.\n");
+    }
+    printf("Tests run: %d\n", mu_tests_run);
+    return result != 0;
+}
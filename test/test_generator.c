@@ -0,0 +1,111 @@
+#include "minunit.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../src/generator.c"
+
+MU_TEST_CASE(test_op_ratios)
+{
+    printf(". testing operation ratios\n");
+    struct mix mix;
+    mix_init(&mix);
+    mix.dist = DIST_UNIFORM;
+    mix.ratio[OP_GET] = 70;
+    mix.ratio[OP_SET] = 20;
+    mix.ratio[OP_INSERT] = 0;
+    mix.ratio[OP_REMOVE] = 10;
+    size_t n_ops = 100000;
+    size_t counts[N_OPS] = {0};
+    srand48(42);
+    struct op *ops = generate_ops(&mix, 1000, n_ops);
+    for (size_t i = 0; i < n_ops; ++i) {
+        counts[ops[i].type]++;
+        MU_ASSERT(ops[i].key < 1000, "Key out of range");
+    }
+    free(ops);
+    MU_ASSERT(counts[OP_INSERT] == 0, "Unexpected insert operation");
+    MU_ASSERT(counts[OP_GET] > 69000 && counts[OP_GET] < 71000,
+              "Get ratio off");
+    MU_ASSERT(counts[OP_REMOVE] > 9500 && counts[OP_REMOVE] < 10500,
+              "Remove ratio off");
+    return 0;
+}
+
+MU_TEST_CASE(test_inserts_append)
+{
+    printf(". testing inserts append new keys\n");
+    struct mix mix;
+    mix_init(&mix);
+    mix.ratio[OP_INSERT] = 50;
+    size_t n_ops = 10000;
+    srand48(42);
+    struct op *ops = generate_ops(&mix, 100, n_ops);
+    size_t next = 100;
+    for (size_t i = 0; i < n_ops; ++i) {
+        if (ops[i].type == OP_INSERT) {
+            MU_ASSERT(ops[i].key == next++, "Inserted key is not new");
+        } else {
+            MU_ASSERT(ops[i].key < next, "Key has not been inserted yet");
+        }
+    }
+    free(ops);
+    MU_ASSERT(next <= mix_max_keys(&mix, 100, n_ops), "Key bound too small");
+    return 0;
+}
+
+MU_TEST_CASE(test_skewed_distributions)
+{
+    printf(". testing zipfian and hotspot skew\n");
+    size_t n_keys = 10000, n_ops = 100000;
+    struct mix mix;
+    mix_init(&mix);
+
+    /* the most popular zipfian key gets ~ 1/zeta(n) of all requests */
+    mix.dist = DIST_ZIPFIAN;
+    size_t *counts = calloc(n_keys, sizeof(size_t));
+    srand48(42);
+    struct op *ops = generate_ops(&mix, n_keys, n_ops);
+    size_t max = 0;
+    for (size_t i = 0; i < n_ops; ++i) {
+        if (++counts[ops[i].key] > max)
+            max = counts[ops[i].key];
+    }
+    free(ops);
+    free(counts);
+    MU_ASSERT(max > n_ops / 20, "Zipfian distribution not skewed");
+
+    /* hot_ops of the requests go to the first hot_set of the keys */
+    mix.dist = DIST_HOTSPOT;
+    ops = generate_ops(&mix, n_keys, n_ops);
+    size_t hot = 0;
+    for (size_t i = 0; i < n_ops; ++i) {
+        hot += ops[i].key < mix.hot_set * n_keys;
+    }
+    free(ops);
+    MU_ASSERT(hot > 0.78 * n_ops && hot < 0.82 * n_ops, "Hotspot ratio off");
+    return 0;
+}
+
+int mu_tests_run = 0;
+
+MU_TEST_SUITE(test_suite)
+{
+    MU_RUN_TEST(test_op_ratios);
+    MU_RUN_TEST(test_inserts_append);
+    MU_RUN_TEST(test_skewed_distributions);
+    return 0;
+}
+
+int main()
+{
+    printf("---=[ Operation stream generator tests\n");
+    char *result = test_suite();
+    if (result != 0) {
+        printf("%s\n", result);
+    } else {
+        printf("All tests passed.\n");
+    }
+    printf("Tests run: %d\n", mu_tests_run);
+    return result != 0;
+}
@@ -0,0 +1,114 @@
+#include "minunit.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../src/hash.c"
+
+MU_TEST_CASE(test_murmur3)
+{
+    printf(". testing murmur3\n");
+    MU_ASSERT(hash_murmur3("", 0, 0) == 0, "Wrong hash of empty key");
+    MU_ASSERT(hash_murmur3("", 0, 1) == 0x514e28b7, "Wrong seeded hash");
+    MU_ASSERT(hash_murmur3("hello", 5, 0) == 0x248bfa47, "Wrong hash");
+    MU_ASSERT(hash_murmur3("hello, world", 12, 0) == 0x149bbb7f,
+              "Wrong hash of a key with full blocks");
+    return 0;
+}
+
+MU_TEST_CASE(test_crc32c)
+{
+    printf(". testing crc32c\n");
+    const char *check = "123456789";
+    hash_select(HASH_CRC32C);
+    MU_ASSERT(hash_crc32c(check, 9, 0) == 0xe3069283, "Wrong check value");
+    /* the table and the instruction agree on every length */
+    const char *s = "the quick brown fox jumps over the lazy dog";
+    for (size_t len = 0; len <= strlen(s); ++len) {
+        MU_ASSERT(~crc32c_sw((const uint8_t *)s, len, ~0u) ==
+                      hash_crc32c(s, len, 0),
+                  "Table and instruction disagree");
+    }
+    return 0;
+}
+
+MU_TEST_CASE(test_seeds)
+{
+    printf(". testing seeds and key lengths\n");
+    const char *s = "abcdefghijklmnopqrstuvwxyz0123456789"
+                    "abcdefghijklmnopqrstuvwxyz";
+    enum hash byte_hashes[] = {HASH_MURMUR3, HASH_WYHASH, HASH_CRC32C,
+#ifdef WITH_XXHASH
+                               HASH_XXH3,
+#endif
+    };
+    for (size_t i = 0; i < sizeof(byte_hashes) / sizeof(byte_hashes[0]);
+         ++i) {
+        hash_select(byte_hashes[i]);
+        /* every length up to and past the 48 byte blocks of wyhash */
+        for (size_t len = 1; len <= strlen(s); ++len) {
+            MU_ASSERT(key_hash(s, len, 0) != key_hash(s, len, 1),
+                      "Seed ignored");
+            MU_ASSERT(key_hash(s, len, 0) != key_hash(s + 1, len, 0),
+                      "Different keys collide");
+        }
+    }
+    return 0;
+}
+
+MU_TEST_CASE(test_int_hashes)
+{
+    printf(". testing int hashes\n");
+    int a = 1, b = 2;
+    MU_ASSERT(hash_int_only(HASH_FIBONACCI) && hash_int_only(HASH_IDENTITY),
+              "Int hashes take strings");
+    MU_ASSERT(!hash_int_only(HASH_MURMUR3), "Murmur3 marked int only");
+    MU_ASSERT(hash_identity(&a, sizeof(int), 0) == 1, "Identity changed key");
+    MU_ASSERT(hash_fibonacci(&a, sizeof(int), 0) !=
+                  hash_fibonacci(&b, sizeof(int), 0),
+              "Fibonacci collision");
+    /* consecutive keys differ in the low bits libhamt looks at first */
+    MU_ASSERT(((hash_fibonacci(&a, sizeof(int), 0) ^
+                hash_fibonacci(&b, sizeof(int), 0)) &
+               0x1f) != 0,
+              "Fibonacci low bits do not mix");
+    return 0;
+}
+
+MU_TEST_CASE(test_parse)
+{
+    printf(". testing hash names\n");
+    enum hash h;
+    MU_ASSERT(hash_parse("wyhash", &h) == 0 && h == HASH_WYHASH,
+              "Failed to parse wyhash");
+    MU_ASSERT(strcmp(hash_name(HASH_CRC32C), "crc32c") == 0, "Wrong name");
+    MU_ASSERT(hash_parse("md5", &h) == -1, "Parsed unknown hash");
+    hash_select(HASH_IDENTITY);
+    MU_ASSERT(key_hash == hash_identity, "Selection failed");
+    return 0;
+}
+
+int mu_tests_run = 0;
+
+MU_TEST_SUITE(test_suite)
+{
+    MU_RUN_TEST(test_murmur3);
+    MU_RUN_TEST(test_crc32c);
+    MU_RUN_TEST(test_seeds);
+    MU_RUN_TEST(test_int_hashes);
+    MU_RUN_TEST(test_parse);
+    return 0;
+}
+
+int main()
+{
+    printf("---=[ Hash function tests\n");
+    char *result = test_suite();
+    if (result != 0) {
+        printf("%s\n", result);
+    } else {
+        printf("All tests passed.\n");
+    }
+    printf("Tests run: %d\n", mu_tests_run);
+    return result != 0;
+}
@@ -0,0 +1,159 @@
+#include "minunit.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../src/alloc.c"
+#include "../src/avl/avl.c"
+#include "../src/libavl_alloc.c"
+
+#define N_ITEMS 1000
+
+static int cmp_int(const void *lhs, const void *rhs, void *param)
+{
+    int l = *(const int *)lhs, r = *(const int *)rhs;
+    return (l > r) - (l < r);
+}
+
+static int items[N_ITEMS];
+
+static struct avl_table *create_tree(size_t capacity)
+{
+    struct libavl_allocator *ator = libavl_allocator_for(
+        ALLOCATOR_SLAB, NULL, sizeof(struct avl_node), capacity);
+    struct avl_table *t = avl_create(cmp_int, NULL, ator);
+    for (int i = 0; i < N_ITEMS; ++i) {
+        /* a permutation of 0..N_ITEMS-1 */
+        items[i] = (i * 7919) % N_ITEMS;
+        avl_insert(t, &items[i]);
+    }
+    return t;
+}
+
+static void destroy_tree(struct avl_table *t)
+{
+    struct libavl_allocator *ator = t->avl_alloc;
+    avl_destroy(t, NULL);
+    libavl_allocator_release(ator);
+}
+
+/* the tree holds exactly 0..N_ITEMS-1 in order and finds all of them */
+static int check_tree(struct avl_table *t)
+{
+    struct avl_traverser trav;
+    int expected = 0;
+    for (int *p = avl_t_first(&trav, t); p; p = avl_t_next(&trav)) {
+        if (*p != expected++)
+            return 0;
+    }
+    for (int i = 0; i < N_ITEMS; ++i) {
+        int key = i;
+        int *p = avl_find(t, &key);
+        if (!p || *p != i)
+            return 0;
+    }
+    return expected == N_ITEMS;
+}
+
+MU_TEST_CASE(test_slab)
+{
+    printf(". testing the slab allocator\n");
+    /* too small a capacity, so that the slab needs several chunks */
+    struct avl_table *t = create_tree(N_ITEMS / 10);
+    MU_ASSERT(check_tree(t), "Tree broken on a slab");
+    struct slab *s = (struct slab *)t->avl_alloc;
+    MU_ASSERT(s->chunks && s->chunks->next, "Slab did not grow");
+    MU_ASSERT(slab_owns(s, t->avl_root), "Node not from the slab");
+    MU_ASSERT(!slab_owns(s, t), "Table allocated from the slab");
+
+    /* freed nodes are recycled first */
+    int key = 500;
+    avl_delete(t, &key);
+    MU_ASSERT(s->free != NULL, "Freed node not on the free list");
+    avl_insert(t, &key);
+    MU_ASSERT(s->free == NULL, "Freed node not recycled");
+    MU_ASSERT(check_tree(t), "Tree broken after recycling");
+    destroy_tree(t);
+    return 0;
+}
+
+MU_TEST_CASE(test_relayout)
+{
+    printf(". testing tree relayout\n");
+    for (int layout = LAYOUT_BFS; layout <= LAYOUT_VEB; ++layout) {
+        struct avl_table *t = create_tree(N_ITEMS);
+        struct slab *s = (struct slab *)t->avl_alloc;
+        struct avl_node *old_root = t->avl_root;
+        libavl_relayout(t->avl_alloc, (void **)&t->avl_root, t->avl_count,
+                        (enum layout)layout);
+        MU_ASSERT(t->avl_root != old_root, "Nodes not moved");
+        MU_ASSERT(s->chunks && !s->chunks->next, "Old chunks not released");
+        MU_ASSERT((char *)t->avl_root == s->chunks->begin,
+                  "Root not laid out first");
+        MU_ASSERT(check_tree(t), "Tree broken by relayout");
+
+        /* the tree stays fully usable */
+        int key = 3;
+        MU_ASSERT(avl_delete(t, &key) != NULL, "Delete after relayout");
+        MU_ASSERT(avl_insert(t, &key) == NULL, "Insert after relayout");
+        MU_ASSERT(check_tree(t), "Tree broken by updates after relayout");
+        destroy_tree(t);
+    }
+    return 0;
+}
+
+MU_TEST_CASE(test_find_batch)
+{
+    printf(". testing batched lookups\n");
+    struct avl_table *t = create_tree(N_ITEMS);
+    /* more keys than one batch, every other one missing */
+    static int keys[2 * N_ITEMS];
+    static void *refs[2 * N_ITEMS];
+    static const void *values[2 * N_ITEMS];
+    for (int i = 0; i < 2 * N_ITEMS; ++i) {
+        keys[i] = i % 2 ? N_ITEMS + i : i / 2;
+        refs[i] = &keys[i];
+    }
+    libavl_find_batch(t->avl_root, t->avl_compare, NULL, refs, values,
+                      2 * N_ITEMS);
+    for (int i = 0; i < 2 * N_ITEMS; ++i) {
+        if (i % 2) {
+            MU_ASSERT(values[i] == NULL, "Found a missing key");
+        } else {
+            MU_ASSERT(values[i] && *(const int *)values[i] == i / 2,
+                      "Wrong item for key");
+        }
+    }
+    destroy_tree(t);
+
+    /* an empty tree finds nothing */
+    t = avl_create(cmp_int, NULL, NULL);
+    values[0] = refs[0];
+    libavl_find_batch(t->avl_root, t->avl_compare, NULL, refs, values, 1);
+    MU_ASSERT(values[0] == NULL, "Found a key in an empty tree");
+    avl_destroy(t, NULL);
+    return 0;
+}
+
+int mu_tests_run = 0;
+
+MU_TEST_SUITE(test_suite)
+{
+    MU_RUN_TEST(test_slab);
+    MU_RUN_TEST(test_relayout);
+    MU_RUN_TEST(test_find_batch);
+    return 0;
+}
+
+int main()
+{
+    printf("---=[ libavl allocator tests\n");
+    char *result = test_suite();
+    if (result != 0) {
+        printf("%s\n", result);
+    } else {
+        printf("All tests passed.\n");
+    }
+    printf("Tests run: %d\n", mu_tests_run);
+    return result != 0;
+}
@@ -0,0 +1,143 @@
+#include "minunit.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../src/rb/rb.c"
+#include "../src/rb/rb_persistent.c"
+
+#define N_KEYS 2000
+#define N_OPS 20000
+#define N_SNAPSHOTS 20
+
+static int keys[N_KEYS];
+
+static int cmp_int(const void *lhs, const void *rhs, void *param)
+{
+    int l = *(const int *)lhs, r = *(const int *)rhs;
+    return (l > r) - (l < r);
+}
+
+/*
+ * Check the red-black invariants of the subtree at p with keys in
+ * (lo, hi); returns its black height, or -1 if an invariant is broken.
+ */
+static int check_node(const struct rb_node *p, int lo, int hi, size_t *count)
+{
+    if (p == NULL)
+        return 1;
+    int key = *(const int *)p->rb_data;
+    if (key <= lo || key >= hi)
+        return -1;
+    for (int dir = 0; dir < 2; ++dir) {
+        const struct rb_node *c = p->rb_link[dir];
+        if (p->rb_color == RB_RED && c && c->rb_color == RB_RED)
+            return -1;
+    }
+    int left = check_node(p->rb_link[0], lo, key, count);
+    int right = check_node(p->rb_link[1], key, hi, count);
+    if (left < 0 || left != right)
+        return -1;
+    ++*count;
+    return left + (p->rb_color == RB_BLACK);
+}
+
+/* the tree is a red-black tree holding exactly the keys set in member */
+static int check_version(const struct rb_table *t, const char *member)
+{
+    size_t count = 0, expected = 0;
+    if (t->rb_root && t->rb_root->rb_color != RB_BLACK)
+        return 0;
+    if (check_node(t->rb_root, -1, N_KEYS, &count) < 0)
+        return 0;
+    for (int i = 0; i < N_KEYS; ++i) {
+        expected += member[i];
+        if ((rb_find(t, &keys[i]) != NULL) != member[i])
+            return 0;
+    }
+    return count == expected && t->rb_count == expected;
+}
+
+MU_TEST_CASE(test_versions)
+{
+    printf(". testing persistent insert and delete\n");
+    static char member[N_KEYS];
+    static char snapshot_member[N_SNAPSHOTS][N_KEYS];
+    const struct rb_table *snapshots[N_SNAPSHOTS] = {0};
+    for (int i = 0; i < N_KEYS; ++i) {
+        keys[i] = i;
+    }
+    srand(1);
+    const struct rb_table *t = rb_create(cmp_int, NULL, NULL);
+    for (int op = 0; op < N_OPS; ++op) {
+        int i = rand() % N_KEYS;
+        /* insert twice as often as delete, so that the tree fills up */
+        const struct rb_table *next = rand() % 3
+                                          ? rb_pinsert(t, &keys[i])
+                                          : rb_pdelete(t, &keys[i]);
+        MU_ASSERT(next, "Out of memory");
+        if (!member[i] && next == t)
+            continue;
+        MU_ASSERT(next != t, "Update did not create a version");
+        member[i] = rb_find(next, &keys[i]) != NULL;
+        t = next;
+        MU_ASSERT(check_version(t, member), "Broken version");
+        if (op % (N_OPS / N_SNAPSHOTS) == 0) {
+            snapshots[op / (N_OPS / N_SNAPSHOTS)] = t;
+            memcpy(snapshot_member[op / (N_OPS / N_SNAPSHOTS)], member,
+                   N_KEYS);
+        }
+    }
+    /* the updates did not change any earlier version */
+    for (int s = 0; s < N_SNAPSHOTS; ++s) {
+        if (snapshots[s])
+            MU_ASSERT(check_version(snapshots[s], snapshot_member[s]),
+                      "Earlier version changed");
+    }
+    /* deleting a missing key returns the version itself */
+    int missing = N_KEYS;
+    MU_ASSERT(rb_pdelete(t, &missing) == t, "Deleted a missing key");
+    /* versions are leaked, see rb_persistent.h */
+    return 0;
+}
+
+MU_TEST_CASE(test_sharing)
+{
+    printf(". testing path copying\n");
+    struct rb_table *t = rb_create(cmp_int, NULL, NULL);
+    for (int i = 0; i < N_KEYS; i += 2) {
+        rb_insert(t, &keys[i]);
+    }
+    int odd = 1001;
+    const struct rb_table *next = rb_pinsert(t, &odd);
+    MU_ASSERT(next->rb_count == t->rb_count + 1, "Wrong count");
+    MU_ASSERT(rb_find(t, &odd) == NULL, "Insert changed the old version");
+    /* the subtree away from the new key is shared */
+    MU_ASSERT(next->rb_root != t->rb_root, "Root not copied");
+    MU_ASSERT(next->rb_root->rb_link[0] == t->rb_root->rb_link[0] ||
+                  next->rb_root->rb_link[1] == t->rb_root->rb_link[1],
+              "Nothing shared");
+    return 0;
+}
+
+int mu_tests_run = 0;
+
+MU_TEST_SUITE(test_suite)
+{
+    MU_RUN_TEST(test_versions);
+    MU_RUN_TEST(test_sharing);
+    return 0;
+}
+
+int main()
+{
+    printf("---=[ Persistent red-black tree tests\n");
+    char *result = test_suite();
+    if (result != 0) {
+        printf("%s\n", result);
+    } else {
+        printf("All tests passed.\n");
+    }
+    printf("Tests run: %d\n", mu_tests_run);
+    return result != 0;
+}
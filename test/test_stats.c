@@ -1,4 +1,5 @@
 #include "minunit.h"
+#include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -21,11 +22,114 @@ MU_TEST_CASE(test_trimmed_mean)
     return 0;
 }
 
+MU_TEST_CASE(test_moments)
+{
+    printf(". testing mean, stddev, median and MAD\n");
+    double x[] = {2.0, 4.0, 4.0, 4.0, 5.0, 5.0, 7.0, 9.0};
+    MU_ASSERT(sample_mean(x, 8) == 5.0, "Error in mean");
+    MU_ASSERT(fabs(sample_stddev(x, 8) - sqrt(32.0 / 7.0)) < 1e-12,
+              "Error in stddev");
+    MU_ASSERT(sample_stddev(x, 1) == 0.0, "Stddev of a single value");
+    MU_ASSERT(median(x, 8) == 4.5, "Error in median of an even count");
+    double y[] = {9.0, 1.0, 2.0, 6.0, 1.0, 4.0, 2.0};
+    MU_ASSERT(median(y, 7) == 2.0, "Error in median of an odd count");
+    MU_ASSERT(y[0] == 9.0, "Median reordered its input");
+    MU_ASSERT(mad(y, 7) == 1.0, "Error in MAD");
+    return 0;
+}
+
+MU_TEST_CASE(test_warmup)
+{
+    printf(". testing warmup detection\n");
+    double x[55];
+    for (size_t i = 0; i < 55; ++i) {
+        /* five slow repetitions, then noise around 10 */
+        x[i] = i < 5 ? 100.0 : (i % 2 ? 9.0 : 11.0);
+    }
+    MU_ASSERT(warmup_length(x, 55) == 5, "Warmup not detected");
+    MU_ASSERT(warmup_length(x + 5, 50) == 0, "Steady state cut");
+    MU_ASSERT(warmup_length(x, 1) == 0, "Cut a single value");
+    return 0;
+}
+
+MU_TEST_CASE(test_outliers)
+{
+    printf(". testing outlier flagging\n");
+    double x[] = {10.0, 10.1, 9.9, 10.0, 10.2, 9.8, 50.0};
+    unsigned char flags[7];
+    MU_ASSERT(flag_outliers(x, 7, flags) == 1, "Wrong number of outliers");
+    MU_ASSERT(flags[6] && !flags[0], "Wrong value flagged");
+    double same[] = {1.0, 1.0, 1.0};
+    MU_ASSERT(flag_outliers(same, 3, flags) == 0, "Flagged constant values");
+    return 0;
+}
+
+MU_TEST_CASE(test_bootstrap)
+{
+    printf(". testing bootstrap confidence intervals\n");
+    double x[40];
+    for (size_t i = 0; i < 40; ++i) {
+        x[i] = 100.0 + (double)((i * 37) % 40) / 4.0;
+    }
+    double lo, hi, lo2, hi2;
+    bootstrap_ci(x, 40, median, 0.95, 1000, 7, &lo, &hi);
+    double med = median(x, 40);
+    MU_ASSERT(lo <= med && med <= hi && lo < hi, "Median outside its CI");
+    bootstrap_ci(x, 40, median, 0.95, 1000, 7, &lo2, &hi2);
+    MU_ASSERT(lo == lo2 && hi == hi2, "Bootstrap not reproducible");
+    bootstrap_ci(x, 40, median, 0.5, 1000, 7, &lo2, &hi2);
+    MU_ASSERT(lo <= lo2 && hi2 <= hi, "Narrower level gave a wider CI");
+    double same[] = {3.0, 3.0, 3.0, 3.0};
+    bootstrap_ci(same, 4, sample_mean, 0.95, 100, 1, &lo, &hi);
+    MU_ASSERT(lo == 3.0 && hi == 3.0, "CI of constant values");
+
+    struct summary s;
+    double y[25];
+    for (size_t i = 0; i < 25; ++i) {
+        y[i] = i < 3 ? 1000.0 : x[i];
+    }
+    summarize(y, 25, &s);
+    MU_ASSERT(s.warmup == 3 && s.n == 22, "Summary kept the warmup");
+    MU_ASSERT(s.ci_lo <= s.median && s.median <= s.ci_hi,
+              "Summary median outside its CI");
+    return 0;
+}
+
+MU_TEST_CASE(test_mann_whitney)
+{
+    printf(". testing Mann-Whitney U\n");
+    double x[] = {1.0, 2.0, 3.0, 4.0, 5.0};
+    double y[] = {6.0, 7.0, 8.0, 9.0, 10.0};
+    double delta;
+    double p = mann_whitney(x, 5, y, 5, &delta);
+    MU_ASSERT(fabs(p - 0.0121858) < 1e-6, "Error in p-value");
+    MU_ASSERT(delta == 1.0, "Error in effect size");
+    MU_ASSERT(mann_whitney(y, 5, x, 5, &delta) == p, "Test not symmetric");
+    MU_ASSERT(delta == -1.0, "Effect size not antisymmetric");
+    /* ties get their mean rank */
+    double xt[] = {1.0, 2.0, 2.0, 3.0};
+    double yt[] = {2.0, 3.0, 3.0, 4.0};
+    p = mann_whitney(xt, 4, yt, 4, &delta);
+    MU_ASSERT(fabs(p - 0.1720337) < 1e-6, "Error in p-value with ties");
+    MU_ASSERT(delta == 0.625, "Error in effect size with ties");
+    /* no difference at all */
+    double same[] = {3.0, 3.0, 3.0};
+    MU_ASSERT(mann_whitney(same, 3, same, 3, &delta) == 1.0,
+              "Error in p-value of identical samples");
+    MU_ASSERT(delta == 0.0, "Error in effect size of identical samples");
+    return 0;
+}
+
 int mu_tests_run = 0;
 
 MU_TEST_SUITE(test_suite)
 {
     MU_RUN_TEST(test_trimmed_mean);
+    MU_RUN_TEST(test_moments);
+    MU_RUN_TEST(test_warmup);
+    MU_RUN_TEST(test_outliers);
+    MU_RUN_TEST(test_bootstrap);
+    MU_RUN_TEST(test_mann_whitney);
     return 0;
 }
 
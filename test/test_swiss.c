@@ -0,0 +1,126 @@
+#include "minunit.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../src/swiss/swiss.c"
+
+#define N_KEYS 100000
+
+static int keys[N_KEYS];
+
+/* a weak hash, so that H2 collisions and long probe sequences happen */
+static uint32_t hash_int(const void *key)
+{
+    return (uint32_t)(*(const int *)key) * 2654435761u;
+}
+
+static int eq_int(const void *lhs, const void *rhs)
+{
+    return *(const int *)lhs == *(const int *)rhs;
+}
+
+MU_TEST_CASE(test_set_get)
+{
+    printf(". testing set and get with growth\n");
+    /* start small so that the map has to grow many times */
+    struct swiss *map =
+        swiss_create(0, hash_int, eq_int, &swiss_allocator_default);
+    for (int i = 0; i < N_KEYS; ++i) {
+        keys[i] = i;
+        MU_ASSERT(swiss_set(map, &keys[i], &keys[i]) == 0, "Set failed");
+    }
+    MU_ASSERT(swiss_size(map) == N_KEYS, "Wrong size");
+    for (int i = 0; i < N_KEYS; ++i) {
+        int *v = swiss_get(map, &i);
+        MU_ASSERT(v && *v == i, "Key not found");
+    }
+    int missing = N_KEYS;
+    MU_ASSERT(swiss_get(map, &missing) == NULL, "Found a missing key");
+    /* replacing keeps the size */
+    swiss_set(map, &keys[7], &keys[8]);
+    MU_ASSERT(swiss_size(map) == N_KEYS, "Replace changed the size");
+    MU_ASSERT(swiss_get(map, &keys[7]) == &keys[8], "Value not replaced");
+    swiss_delete(map);
+    return 0;
+}
+
+MU_TEST_CASE(test_remove)
+{
+    printf(". testing remove and tombstone reuse\n");
+    struct swiss *map =
+        swiss_create(N_KEYS, hash_int, eq_int, &swiss_allocator_default);
+    size_t capacity = map->mask + 1;
+    for (int i = 0; i < N_KEYS; ++i) {
+        swiss_set(map, &keys[i], &keys[i]);
+    }
+    for (int i = 0; i < N_KEYS; i += 2) {
+        MU_ASSERT(swiss_remove(map, &keys[i]) == 1, "Remove failed");
+    }
+    MU_ASSERT(swiss_remove(map, &keys[0]) == 0, "Removed a key twice");
+    MU_ASSERT(swiss_size(map) == N_KEYS / 2, "Wrong size after remove");
+    for (int i = 0; i < N_KEYS; ++i) {
+        void *v = swiss_get(map, &keys[i]);
+        MU_ASSERT(i % 2 ? v == &keys[i] : v == NULL, "Wrong lookup result");
+    }
+    /* churn at constant size must not grow the table */
+    for (int round = 0; round < 20; ++round) {
+        for (int i = 0; i < N_KEYS; i += 2) {
+            swiss_set(map, &keys[i], &keys[i]);
+        }
+        for (int i = 0; i < N_KEYS; i += 2) {
+            swiss_remove(map, &keys[i]);
+        }
+    }
+    MU_ASSERT(map->mask + 1 == capacity, "Churn grew the table");
+    MU_ASSERT(swiss_size(map) == N_KEYS / 2, "Wrong size after churn");
+    for (int i = 1; i < N_KEYS; i += 2) {
+        MU_ASSERT(swiss_get(map, &keys[i]) == &keys[i], "Lost a key");
+    }
+    swiss_delete(map);
+    return 0;
+}
+
+MU_TEST_CASE(test_next)
+{
+    printf(". testing iteration\n");
+    struct swiss *map =
+        swiss_create(0, hash_int, eq_int, &swiss_allocator_default);
+    for (int i = 0; i < 1000; ++i) {
+        swiss_set(map, &keys[i], &keys[i]);
+    }
+    size_t pos = 0, n = 0;
+    long sum = 0;
+    void *key, *value;
+    while (swiss_next(map, &pos, &key, &value)) {
+        MU_ASSERT(key == value, "Key and value out of step");
+        sum += *(int *)key;
+        n++;
+    }
+    MU_ASSERT(n == 1000 && sum == 999 * 1000 / 2, "Wrong entries visited");
+    swiss_delete(map);
+    return 0;
+}
+
+int mu_tests_run = 0;
+
+MU_TEST_SUITE(test_suite)
+{
+    MU_RUN_TEST(test_set_get);
+    MU_RUN_TEST(test_remove);
+    MU_RUN_TEST(test_next);
+    return 0;
+}
+
+int main()
+{
+    printf("---=[ Swiss table tests\n");
+    char *result = test_suite();
+    if (result != 0) {
+        printf("%s\n", result);
+    } else {
+        printf("All tests passed.\n");
+    }
+    printf("Tests run: %d\n", mu_tests_run);
+    return result != 0;
+}
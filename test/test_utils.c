@@ -0,0 +1,164 @@
+#include "minunit.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../src/utils.c"
+
+MU_TEST_CASE(test_hist_exact_small_values)
+{
+    printf(". testing exact histogram buckets\n");
+    struct histogram h;
+    hist_reset(&h);
+    for (uint64_t v = 1; v <= 50; ++v) {
+        hist_record(&h, v);
+    }
+    MU_ASSERT(h.n == 50, "Wrong sample count");
+    MU_ASSERT(hist_percentile(&h, 50.0) == 25, "Wrong median");
+    MU_ASSERT(hist_percentile(&h, 100.0) == 50, "Wrong maximum");
+    MU_ASSERT(hist_percentile(&h, 0.0) == 1, "Wrong minimum");
+    return 0;
+}
+
+MU_TEST_CASE(test_hist_relative_error)
+{
+    printf(". testing histogram relative error\n");
+    /* every value maps to a bucket whose range contains the value */
+    for (uint64_t v = 1; v < (1ULL << 40); v = v * 3 / 2 + 1) {
+        struct histogram h;
+        hist_reset(&h);
+        hist_record(&h, v);
+        hist_record(&h, UINT64_MAX >> 1);
+        uint64_t p = hist_percentile(&h, 50.0);
+        MU_ASSERT(p >= v, "Percentile below recorded value");
+        MU_ASSERT(p - v <= v / HIST_SUB_BUCKETS, "Relative error too large");
+        MU_ASSERT(hist_index(v) < HIST_N_BUCKETS, "Bucket out of range");
+    }
+    MU_ASSERT(hist_index(UINT64_MAX) == HIST_N_BUCKETS - 1,
+              "Largest value not in last bucket");
+    return 0;
+}
+
+MU_TEST_CASE(test_hist_tail)
+{
+    printf(". testing histogram tail percentiles\n");
+    struct histogram h;
+    hist_reset(&h);
+    for (int i = 0; i < 990; ++i) {
+        hist_record(&h, 40);
+    }
+    for (int i = 0; i < 10; ++i) {
+        hist_record(&h, 10000);
+    }
+    MU_ASSERT(hist_percentile(&h, 99.0) == 40, "Wrong p99");
+    uint64_t p999 = hist_percentile(&h, 99.9);
+    MU_ASSERT(p999 >= 10000 && p999 <= 10000 + 10000 / HIST_SUB_BUCKETS,
+              "Wrong p99.9");
+    return 0;
+}
+
+MU_TEST_CASE(test_sampler_every)
+{
+    printf(". testing sampling rate\n");
+    struct histogram h;
+    struct sampler s;
+    sampler_init(&s, &h, 4);
+    for (int i = 0; i < 100; ++i) {
+        sampler_begin(&s);
+        sampler_end(&s);
+    }
+    MU_ASSERT(h.n == 25, "Wrong number of samples");
+    sampler_init(&s, &h, 0);
+    for (int i = 0; i < 100; ++i) {
+        sampler_begin(&s);
+        sampler_end(&s);
+    }
+    MU_ASSERT(h.n == 0, "Disabled sampler recorded samples");
+    return 0;
+}
+
+MU_TEST_CASE(test_timer)
+{
+    printf(". testing calibrated timer\n");
+    timer_calibrate();
+    MU_ASSERT(ticks_per_nsec() > 0.0, "Tick rate not calibrated");
+    /* the overhead is subtracted, without wrapping around */
+    MU_ASSERT(ticks_elapsed(100, 100) == 0, "Negative interval");
+    uint64_t empty = UINT64_MAX;
+    for (int i = 0; i < 10000; ++i) {
+        uint64_t begin = ticks_begin();
+        uint64_t ticks = ticks_elapsed(begin, ticks_end());
+        if (ticks < empty)
+            empty = ticks;
+    }
+    MU_ASSERT(empty <= ticks_overhead,
+              "Overhead of an empty region not subtracted");
+    /* intervals accumulate across stop and continue */
+    struct TimeInterval ti;
+    struct timespec ms = {0, 1000000};
+    timer_start(&ti);
+    nanosleep(&ms, NULL);
+    timer_stop(&ti);
+    nanosleep(&ms, NULL);
+    timer_continue(&ti);
+    nanosleep(&ms, NULL);
+    timer_stop(&ti);
+    long nsec = timer_nsec(&ti);
+    MU_ASSERT(nsec >= 2000000 && nsec < 50000000, "Wrong interval length");
+    MU_ASSERT(ti.end - ti.begin < ti.ticks, "Wrong last interval");
+    return 0;
+}
+
+MU_TEST_CASE(test_shuffle)
+{
+    printf(". testing shuffle\n");
+    /* a permutation, with every element (the last one too) moving */
+    enum { N = 8, ROUNDS = 1000 };
+    int moved[N] = {0};
+    for (int r = 0; r < ROUNDS; ++r) {
+        int a[N], seen[N] = {0};
+        for (int i = 0; i < N; ++i)
+            a[i] = i;
+        shuffle(a, N, sizeof(int));
+        for (int i = 0; i < N; ++i) {
+            MU_ASSERT(a[i] >= 0 && a[i] < N && !seen[a[i]],
+                      "Not a permutation");
+            seen[a[i]] = 1;
+            moved[i] += a[i] != i;
+        }
+    }
+    /* each element stays put with probability 1/N */
+    for (int i = 0; i < N; ++i)
+        MU_ASSERT(moved[i] > ROUNDS * (N - 1) / N * 9 / 10, "Biased shuffle");
+    int one = 42;
+    shuffle(&one, 1, sizeof(int));
+    shuffle(NULL, 0, sizeof(int));
+    MU_ASSERT(one == 42, "Single element moved");
+    return 0;
+}
+
+int mu_tests_run = 0;
+
+MU_TEST_SUITE(test_suite)
+{
+    MU_RUN_TEST(test_hist_exact_small_values);
+    MU_RUN_TEST(test_hist_relative_error);
+    MU_RUN_TEST(test_hist_tail);
+    MU_RUN_TEST(test_sampler_every);
+    MU_RUN_TEST(test_timer);
+    MU_RUN_TEST(test_shuffle);
+    return 0;
+}
+
+int main()
+{
+    printf("---=[ Timer and histogram tests\n");
+    char *result = test_suite();
+    if (result != 0) {
+        printf("%s\n", result);
+    } else {
+        printf("All tests passed.\n");
+    }
+    printf("Tests run: %d\n", mu_tests_run);
+    return result != 0;
+}